@@ -45,8 +45,13 @@
    MEMORY SETTINGS
  *=========================*/
 
+/* The port's TLSF / slab allocator replaces lv_mem with LV_PORT_MEM=1, see lvgl_port_mem.h */
+#ifndef LV_PORT_MEM
+    #define LV_PORT_MEM 0
+#endif
+
 /*1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()`*/
-#define LV_MEM_CUSTOM 0
+#define LV_MEM_CUSTOM LV_PORT_MEM
 #if LV_MEM_CUSTOM == 0
     /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
     #define LV_MEM_SIZE (64U * 1024U)          /*[bytes]*/
@@ -60,10 +65,10 @@
     #endif
 
 #else       /*LV_MEM_CUSTOM*/
-    #define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-    #define LV_MEM_CUSTOM_ALLOC   malloc
-    #define LV_MEM_CUSTOM_FREE    free
-    #define LV_MEM_CUSTOM_REALLOC realloc
+    #define LV_MEM_CUSTOM_INCLUDE "lvgl_port_mem.h"   /*Header for the dynamic memory function*/
+    #define LV_MEM_CUSTOM_ALLOC   lvgl_port_mem_alloc
+    #define LV_MEM_CUSTOM_FREE    lvgl_port_mem_free
+    #define LV_MEM_CUSTOM_REALLOC lvgl_port_mem_realloc
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Number of the intermediate memory buffer used during rendering and other internal processing mechanisms.
@@ -85,10 +90,10 @@
 
 /*Use a custom tick source that tells the elapsed time in milliseconds.
  *It removes the need to manually update the tick with `lv_tick_inc()`)*/
-#define LV_TICK_CUSTOM 0
+#define LV_TICK_CUSTOM 1
 #if LV_TICK_CUSTOM
-    #define LV_TICK_CUSTOM_INCLUDE "Arduino.h"         /*Header for the system time function*/
-    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())    /*Expression evaluating to current system time in ms*/
+    #define LV_TICK_CUSTOM_INCLUDE "lvgl_port_tick.h"         /*Header for the system time function*/
+    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (lvgl_port_tick_get())    /*Expression evaluating to current system time in ms*/
 #endif   /*LV_TICK_CUSTOM*/
 
 /*Default Dot Per Inch. Used to initialize default sizes such as widgets sized, style paddings.
@@ -103,6 +108,28 @@
  * Drawing
  *-----------*/
 
+/* Render cache profile of the board: sets the cache sizes below and the budget the port's cache manager
+ * rebalances at runtime (lvgl_port_cache.hpp). 0: no caches, 1: internal RAM only, 2: PSRAM,
+ * 3: desktop sized caches (opt-in). The emulator envs in platformio.ini set the profile of their device. */
+#ifndef LV_PORT_CACHE_PROFILE
+    #if !defined(ARDUINO) || defined(BOARD_HAS_PSRAM)
+        #define LV_PORT_CACHE_PROFILE 2
+    #else
+        #define LV_PORT_CACHE_PROFILE 1
+    #endif
+#endif
+#ifndef LV_PORT_CACHE_BUDGET
+    #if LV_PORT_CACHE_PROFILE == 3
+        #define LV_PORT_CACHE_BUDGET (8U * 1024U * 1024U)
+    #elif LV_PORT_CACHE_PROFILE == 2
+        #define LV_PORT_CACHE_BUDGET (1024U * 1024U)
+    #elif LV_PORT_CACHE_PROFILE == 1
+        #define LV_PORT_CACHE_BUDGET (32U * 1024U)
+    #else
+        #define LV_PORT_CACHE_BUDGET 0
+    #endif
+#endif
+
 /*Enable complex draw engine.
  *Required to draw shadow, gradient, rounded corners, circles, arc, skew lines, image transformations or any masks*/
 #define LV_DRAW_COMPLEX 1
@@ -111,13 +138,21 @@
     /*Allow buffering some shadow calculation.
     *LV_SHADOW_CACHE_SIZE is the max. shadow size to buffer, where shadow size is `shadow_width + radius`
     *Caching has LV_SHADOW_CACHE_SIZE^2 RAM cost*/
-    #define LV_SHADOW_CACHE_SIZE 0
+    #if LV_PORT_CACHE_PROFILE >= 2
+        #define LV_SHADOW_CACHE_SIZE 32
+    #else
+        #define LV_SHADOW_CACHE_SIZE 0
+    #endif
 
     /* Set number of maximally cached circle data.
     * The circumference of 1/4 circle are saved for anti-aliasing
     * radius * 4 bytes are used per circle (the most often used radiuses are saved)
     * 0: to disable caching */
-    #define LV_CIRCLE_CACHE_SIZE 4
+    #if LV_PORT_CACHE_PROFILE >= 2
+        #define LV_CIRCLE_CACHE_SIZE 8
+    #else
+        #define LV_CIRCLE_CACHE_SIZE 4
+    #endif
 #endif /*LV_DRAW_COMPLEX*/
 
 /**
@@ -141,7 +176,13 @@
  *With complex image decoders (e.g. PNG or JPG) caching can save the continuous open/decode of images.
  *However the opened images might consume additional RAM.
  *0: to disable caching*/
-#define LV_IMG_CACHE_DEF_SIZE 0
+#if LV_PORT_CACHE_PROFILE >= 2
+    #define LV_IMG_CACHE_DEF_SIZE 8
+#elif LV_PORT_CACHE_PROFILE == 1
+    #define LV_IMG_CACHE_DEF_SIZE 2
+#else
+    #define LV_IMG_CACHE_DEF_SIZE 0
+#endif
 
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
@@ -152,7 +193,13 @@
  *LV_GRAD_CACHE_DEF_SIZE sets the size of this cache in bytes.
  *If the cache is too small the map will be allocated only while it's required for the drawing.
  *0 mean no caching.*/
-#define LV_GRAD_CACHE_DEF_SIZE 0
+#if LV_PORT_CACHE_PROFILE >= 2
+    #define LV_GRAD_CACHE_DEF_SIZE 4096
+#elif LV_PORT_CACHE_PROFILE == 1
+    #define LV_GRAD_CACHE_DEF_SIZE 1024
+#else
+    #define LV_GRAD_CACHE_DEF_SIZE 0
+#endif
 
 /*Allow dithering the gradients (to achieve visual smooth color gradients on limited color depth display)
  *LV_DITHER_GRADIENT implies allocating one or two more lines of the object's rendering surface
@@ -40,7 +40,15 @@
  * - LV_STDLIB_RTTHREAD:    RT-Thread implementation
  * - LV_STDLIB_CUSTOM:      Implement the functions externally
  */
-#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+/* The port's TLSF / slab allocator replaces the built-in one with LV_PORT_MEM=1, see lvgl_port_mem.h */
+#ifndef LV_PORT_MEM
+    #define LV_PORT_MEM 0
+#endif
+#if LV_PORT_MEM
+    #define LV_USE_STDLIB_MALLOC    LV_STDLIB_CUSTOM
+#else
+    #define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+#endif
 
 /** Possible values
  * - LV_STDLIB_BUILTIN:     LVGL's built in implementation
@@ -94,6 +102,28 @@
  * (Not so important, you can adjust it to modify default sizes and spaces.) */
 #define LV_DPI_DEF 130              /**< [px/inch] */
 
+/** Render cache profile of the board: sets the cache sizes below and the budget the port's cache manager
+ *  rebalances at runtime (lvgl_port_cache.hpp). 0: no caches, 1: internal RAM only, 2: PSRAM,
+ *  3: desktop sized caches (opt-in). The emulator envs in platformio.ini set the profile of their device. */
+#ifndef LV_PORT_CACHE_PROFILE
+    #if !defined(ARDUINO) || defined(BOARD_HAS_PSRAM)
+        #define LV_PORT_CACHE_PROFILE 2
+    #else
+        #define LV_PORT_CACHE_PROFILE 1
+    #endif
+#endif
+#ifndef LV_PORT_CACHE_BUDGET
+    #if LV_PORT_CACHE_PROFILE == 3
+        #define LV_PORT_CACHE_BUDGET (8U * 1024U * 1024U)
+    #elif LV_PORT_CACHE_PROFILE == 2
+        #define LV_PORT_CACHE_BUDGET (1024U * 1024U)
+    #elif LV_PORT_CACHE_PROFILE == 1
+        #define LV_PORT_CACHE_BUDGET (32U * 1024U)
+    #else
+        #define LV_PORT_CACHE_BUDGET 0
+    #endif
+#endif
+
 /*=================
  * OPERATING SYSTEM
  *=================*/
@@ -107,7 +137,17 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+/* The port enables the OS layer when rendering with more than one draw unit, see LV_PORT_DRAW_UNITS */
+#ifndef LV_PORT_DRAW_UNITS
+    #define LV_PORT_DRAW_UNITS 1
+#endif
+#if LV_PORT_DRAW_UNITS > 1 && defined(ARDUINO)
+    #define LV_USE_OS   LV_OS_FREERTOS
+#elif LV_PORT_DRAW_UNITS > 1
+    #define LV_USE_OS   LV_OS_PTHREAD
+#else
+    #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -192,7 +232,7 @@
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
      *  - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #define LV_DRAW_SW_DRAW_UNIT_CNT    LV_PORT_DRAW_UNITS
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -209,13 +249,21 @@
         /** Allow buffering some shadow calculation.
          *  LV_DRAW_SW_SHADOW_CACHE_SIZE is the maximum shadow size to buffer, where shadow size is
          *  `shadow_width + radius`.  Caching has LV_DRAW_SW_SHADOW_CACHE_SIZE^2 RAM cost. */
-        #define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
+        #if LV_PORT_CACHE_PROFILE >= 2
+            #define LV_DRAW_SW_SHADOW_CACHE_SIZE 32
+        #else
+            #define LV_DRAW_SW_SHADOW_CACHE_SIZE 0
+        #endif
 
         /** Set number of maximally-cached circle data.
          *  The circumference of 1/4 circle are saved for anti-aliasing.
          *  `radius * 4` bytes are used per circle (the most often used radiuses are saved).
          *  - 0: disables caching */
-        #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+        #if LV_PORT_CACHE_PROFILE >= 2
+            #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 8
+        #else
+            #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+        #endif
     #endif
 
     #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
@@ -458,11 +506,19 @@
  *  If size is not set to 0, the decoder will fail to decode when the cache is full.
  *  If size is 0, the cache function is not enabled and the decoded memory will be
  *  released immediately after use. */
+/* Left at 0, the port's cache manager sizes the image cache at runtime: LVGL fails to decode images larger than
+ * the cache, so it only turns the cache on when its budget holds a full screen image */
 #define LV_CACHE_DEF_SIZE       0
 
 /** Default number of image header cache entries. The cache is used to store the headers of images
  *  The main logic is like `LV_CACHE_DEF_SIZE` but for image headers. */
-#define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
+#if LV_PORT_CACHE_PROFILE >= 2
+    #define LV_IMAGE_HEADER_CACHE_DEF_CNT 32
+#elif LV_PORT_CACHE_PROFILE == 1
+    #define LV_IMAGE_HEADER_CACHE_DEF_CNT 8
+#else
+    #define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
+#endif
 
 /** Number of stops allowed per gradient. Increase this to allow more stops.
  *  This adds (sizeof(lv_color_t) + 1) bytes per additional stop. */
@@ -21,6 +21,6 @@ void loop(void)
 #if defined(ARDUINO) && defined(ESP_PLATFORM)
     delay(10);
 #elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    usleep(10 * 000);
+    usleep(10 * 1000);
 #endif
 }
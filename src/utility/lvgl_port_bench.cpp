@@ -0,0 +1,290 @@
+#include "lvgl_port_bench.hpp"
+#include "lvgl_port_mem.h"
+#include "lvgl_port_rgb565.hpp"
+#include <cmath>    // for sqrt
+#include <cstdio>   // for fopen, fprintf
+#include <cstdlib>  // for malloc
+
+#define LVGL_BENCH_STR_(x) #x
+#define LVGL_BENCH_STR(x)  LVGL_BENCH_STR_(x)
+#define LVGL_BENCH_OBJ_CNT 8
+
+typedef struct {
+    const char *name;
+    uint32_t count;  // moving objects, 0: one full screen object
+    lv_obj_t *(*create)(lv_obj_t *parent, uint32_t i);
+} lvgl_bench_scene_t;
+
+typedef struct {
+    double render_us;
+    double flush_us;
+    double frame_us;
+} lvgl_bench_sample_t;
+
+static lvgl_port_bench_config_t bench_config = {NULL, 5, 30, 5};
+static bool bench_requested;
+
+static lv_color_t lvgl_bench_color(uint32_t i)
+{
+    static const lv_palette_t palette[] = {LV_PALETTE_RED,   LV_PALETTE_BLUE,  LV_PALETTE_GREEN, LV_PALETTE_ORANGE,
+                                           LV_PALETTE_PURPLE, LV_PALETTE_TEAL, LV_PALETTE_PINK,  LV_PALETTE_INDIGO};
+    return lv_palette_main(palette[i % (sizeof(palette) / sizeof(palette[0]))]);
+}
+
+static lv_obj_t *lvgl_bench_rect(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(obj, lvgl_bench_color(i), 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_rounded(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_rect(parent, i);
+    lv_obj_set_style_radius(obj, 16, 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_border(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_rounded(parent, i);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(obj, 6, 0);
+    lv_obj_set_style_border_color(obj, lvgl_bench_color(i), 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_shadow(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_rounded(parent, i);
+    lv_obj_set_style_shadow_width(obj, 24, 0);
+    lv_obj_set_style_shadow_color(obj, lvgl_bench_color(i + 1), 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_gradient(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_rect(parent, i);
+    lv_obj_set_style_bg_grad_color(obj, lvgl_bench_color(i + 3), 0);
+    lv_obj_set_style_bg_grad_dir(obj, (i & 1) ? LV_GRAD_DIR_HOR : LV_GRAD_DIR_VER, 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_opacity(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_rounded(parent, i);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_50, 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_text(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lv_label_create(parent);
+    lv_label_set_text(obj, "The quick brown fox jumps over the lazy dog. 0123456789");
+    lv_obj_set_style_text_color(obj, lvgl_bench_color(i), 0);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_arc(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lv_arc_create(parent);
+    lv_arc_set_value(obj, 30 + i * 8);
+    lv_obj_set_style_arc_color(obj, lvgl_bench_color(i), LV_PART_INDICATOR);
+    return obj;
+}
+
+static lv_obj_t *lvgl_bench_full_screen(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lvgl_bench_gradient(parent, i);
+    lv_obj_set_size(obj, lv_obj_get_width(parent), lv_obj_get_height(parent));
+    return obj;
+}
+
+static const lvgl_bench_scene_t bench_scenes[] = {
+    {"rectangle", LVGL_BENCH_OBJ_CNT, lvgl_bench_rect},
+    {"rounded", LVGL_BENCH_OBJ_CNT, lvgl_bench_rounded},
+    {"border", LVGL_BENCH_OBJ_CNT, lvgl_bench_border},
+    {"shadow", LVGL_BENCH_OBJ_CNT, lvgl_bench_shadow},
+    {"gradient", LVGL_BENCH_OBJ_CNT, lvgl_bench_gradient},
+    {"opacity", LVGL_BENCH_OBJ_CNT, lvgl_bench_opacity},
+    {"text", LVGL_BENCH_OBJ_CNT, lvgl_bench_text},
+    {"arc", LVGL_BENCH_OBJ_CNT, lvgl_bench_arc},
+    {"full_screen", 0, lvgl_bench_full_screen},
+};
+
+// Moves the objects of a scene along fixed paths, so every run renders the same frames
+static void lvgl_bench_step(lv_obj_t *parent, const lvgl_bench_scene_t *scene, lv_obj_t **objs, uint32_t frame)
+{
+    const int32_t w = lv_obj_get_width(parent);
+    const int32_t h = lv_obj_get_height(parent);
+    if (scene->count == 0) {
+        lv_obj_set_style_bg_color(objs[0], lvgl_bench_color(frame), 0);
+        return;
+    }
+    for (uint32_t i = 0; i < scene->count; i++) {
+        const int32_t range_x = LV_MAX(w - lv_obj_get_width(objs[i]), 1);
+        const int32_t range_y = LV_MAX(h - lv_obj_get_height(objs[i]), 1);
+        lv_obj_set_pos(objs[i], (int32_t)((i * 37 + frame * 7) % range_x), (int32_t)((i * 53 + frame * 5) % range_y));
+    }
+}
+
+static lvgl_bench_sample_t lvgl_bench_measure(lv_obj_t *parent, const lvgl_bench_scene_t *scene, lv_obj_t **objs,
+                                              uint32_t *frame, uint32_t frames)
+{
+    lvgl_bench_sample_t sample = {0, 0, 0};
+    lvgl_port_frame_info_t info;
+    for (uint32_t i = 0; i < frames; i++) {
+        lvgl_bench_step(parent, scene, objs, (*frame)++);
+        lvgl_port_refresh_now();
+        lvgl_port_get_frame_info(&info);
+        sample.render_us += info.render_us;
+        sample.flush_us += info.flush_us;
+        sample.frame_us += info.frame_us;
+    }
+    sample.render_us /= frames;
+    sample.flush_us /= frames;
+    sample.frame_us /= frames;
+    return sample;
+}
+
+static void lvgl_bench_write_scene(FILE *f, const char *name, const lvgl_bench_sample_t *samples, uint32_t count,
+                                   bool first)
+{
+    lvgl_bench_sample_t mean = {0, 0, 0};
+    for (uint32_t i = 0; i < count; i++) {
+        mean.render_us += samples[i].render_us / count;
+        mean.flush_us += samples[i].flush_us / count;
+        mean.frame_us += samples[i].frame_us / count;
+    }
+    double var = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        var += (samples[i].frame_us - mean.frame_us) * (samples[i].frame_us - mean.frame_us);
+    }
+    const double sd = count > 1 ? sqrt(var / (count - 1)) : 0;
+
+    fprintf(f, "%s\n    {\"name\": \"%s\", \"render_us\": %.1f, \"flush_us\": %.1f, \"frame_us\": %.1f,",
+            first ? "" : ",", name, mean.render_us, mean.flush_us, mean.frame_us);
+    fprintf(f, " \"frame_us_sd\": %.1f, \"fps\": %.1f, \"frame_us_samples\": [", sd,
+            mean.frame_us > 0 ? 1e6 / mean.frame_us : 0.0);
+    for (uint32_t i = 0; i < count; i++) {
+        fprintf(f, "%s%.1f", i ? ", " : "", samples[i].frame_us);
+    }
+    fprintf(f, "]}");
+}
+
+extern "C" void lvgl_port_bench_request(const lvgl_port_bench_config_t *config)
+{
+    bench_config.output = config->output;
+    if (config->warmup) {
+        bench_config.warmup = config->warmup;
+    }
+    if (config->frames) {
+        bench_config.frames = config->frames;
+    }
+    if (config->samples) {
+        bench_config.samples = config->samples;
+    }
+    bench_requested = true;
+}
+
+extern "C" bool lvgl_port_bench_requested(void)
+{
+    return bench_requested;
+}
+
+extern "C" bool lvgl_port_bench_run(void)
+{
+    const char *path     = bench_config.output ? bench_config.output : "-";
+    const bool to_stdout = (path[0] == '-' && path[1] == '\0');
+
+    lvgl_bench_sample_t *samples = (lvgl_bench_sample_t *)malloc(bench_config.samples * sizeof(lvgl_bench_sample_t));
+    if (samples == NULL) {
+        printf("ERROR: Failed to allocate %u benchmark samples\n", (unsigned)bench_config.samples);
+        return false;
+    }
+    FILE *f = to_stdout ? stdout : fopen(path, "w");
+    if (f == NULL) {
+        printf("ERROR: Cannot write benchmark results to %s\n", path);
+        free(samples);
+        return false;
+    }
+
+#if LVGL_USE_V8 == 1
+    lv_obj_t *screen = lv_scr_act();
+#else
+    lv_obj_t *screen = lv_screen_active();
+#endif
+    lv_obj_t *parent = lv_obj_create(screen);
+    lv_obj_remove_style_all(parent);
+    lv_obj_set_size(parent, lv_obj_get_width(screen), lv_obj_get_height(screen));
+    lv_obj_set_style_bg_opa(parent, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(parent, lv_color_white(), 0);
+    lv_obj_update_layout(parent);
+
+    fprintf(f, "{\n  \"lvgl\": \"%d.%d.%d\",", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+#ifdef M5GFX_BOARD
+    fprintf(f, " \"board\": \"%s\",", LVGL_BENCH_STR(M5GFX_BOARD));
+#endif
+    fprintf(f, " \"width\": %d, \"height\": %d, \"rgb565_kernel\": \"%s\",\n", (int)lv_obj_get_width(screen),
+            (int)lv_obj_get_height(screen), lvgl_port_rgb565_kernel_name());
+#if LVGL_USE_V9 == 1
+    fprintf(f, "  \"draw_units\": %d,\n", (int)LV_DRAW_SW_DRAW_UNIT_CNT);
+#else
+    fprintf(f, "  \"draw_units\": 1,\n");
+#endif
+    fprintf(f, "  \"warmup\": %u, \"frames\": %u, \"samples\": %u,\n  \"scenes\": [", (unsigned)bench_config.warmup,
+            (unsigned)bench_config.frames, (unsigned)bench_config.samples);
+
+#if LV_PORT_MEM
+    lvgl_port_mem_stats_t mem;
+    lvgl_port_mem_get_stats(&mem);  // starts the allocation rate window
+#endif
+    for (size_t s = 0; s < sizeof(bench_scenes) / sizeof(bench_scenes[0]); s++) {
+        const lvgl_bench_scene_t *scene = &bench_scenes[s];
+        lv_obj_t *objs[LVGL_BENCH_OBJ_CNT];
+        const uint32_t count = scene->count ? scene->count : 1;
+        for (uint32_t i = 0; i < count; i++) {
+            objs[i] = scene->create(parent, i);
+            if (scene->count) {
+                lv_obj_set_size(objs[i], lv_obj_get_width(parent) / 3, lv_obj_get_height(parent) / 3);
+            }
+        }
+        lv_obj_update_layout(parent);
+
+        uint32_t frame = 0;
+        lvgl_bench_measure(parent, scene, objs, &frame, bench_config.warmup);
+        for (uint32_t i = 0; i < bench_config.samples; i++) {
+            samples[i] = lvgl_bench_measure(parent, scene, objs, &frame, bench_config.frames);
+        }
+        lvgl_bench_write_scene(f, scene->name, samples, bench_config.samples, s == 0);
+        if (!to_stdout) {
+            printf("bench: %-12s %8.1f us/frame\n", scene->name, samples[bench_config.samples - 1].frame_us);
+        }
+
+        lv_obj_clean(parent);
+    }
+#if LV_PORT_MEM
+    lvgl_port_mem_get_stats(&mem);
+    fprintf(f, "\n  ],\n  \"memory\": {\"total\": %u, \"max_used\": %u, \"pools\": %u, \"frag_pct\": %u, ",
+            (unsigned)mem.total, (unsigned)mem.max_used, (unsigned)mem.pools, (unsigned)mem.frag_pct);
+    fprintf(f, "\"allocs\": %u, \"alloc_rate\": %u}\n}\n", (unsigned)mem.allocs, (unsigned)mem.alloc_rate);
+#else
+    fprintf(f, "\n  ]\n}\n");
+#endif
+    free(samples);
+
+#if LVGL_USE_V8 == 1
+    lv_obj_del(parent);
+#else
+    lv_obj_delete(parent);
+#endif
+    lvgl_port_refresh_now();
+
+    bool ok = !ferror(f);
+    if (!to_stdout) {
+        ok = (fclose(f) == 0) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,31 @@
+#ifndef __LVGL_PORT_BENCH_HPP__
+#define __LVGL_PORT_BENCH_HPP__
+
+#include "lvgl_port_m5stack.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *output;  // JSON result file, "-" for stdout
+    uint32_t warmup;     // frames rendered before the first sample of a scene
+    uint32_t frames;     // frames per sample
+    uint32_t samples;    // samples per scene
+} lvgl_port_bench_config_t;
+
+// Makes sdl_main.cpp run the benchmark instead of the app and exit with its result, called for --bench <file>.
+// Zero fields keep their defaults.
+void lvgl_port_bench_request(const lvgl_port_bench_config_t *config);
+bool lvgl_port_bench_requested(void);
+
+// Renders every benchmark scene and writes render/flush time and FPS per scene as JSON.
+// Frames are driven with lvgl_port_refresh_now(), so the results do not depend on the clock or refresh period.
+// Call with the GUI lock held, returns false when the results could not be written.
+bool lvgl_port_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_BENCH_HPP__
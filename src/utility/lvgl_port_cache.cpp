@@ -0,0 +1,503 @@
+#include "lvgl_port_cache.hpp"
+#include "lvgl_port_glyph.hpp"
+#include "lvgl_port_mem.h"
+#include <atomic>
+
+#if LVGL_USE_V8 == 1
+#include "src/misc/lv_gc.h"  // for the decoder list
+#else
+#include "lvgl_private.h"  // for the cache classes
+#endif
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+
+extern "C" void lvgl_port_cache_heap(uint32_t *capacity, uint32_t *free_pct)
+{
+#if LV_PORT_MEM
+    lvgl_port_mem_stats_t mem;
+    lvgl_port_mem_get_stats(&mem);
+    uint64_t limit = LV_PORT_MEM_MAX_SIZE;
+    if (limit == 0) {
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#if defined(BOARD_HAS_PSRAM)
+        limit = mem.total + heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+#else
+        limit = mem.total + heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#endif
+#else
+        // The emulator's pools grow as long as the host has memory
+        *capacity = UINT32_MAX;
+        *free_pct = 100;
+        return;
+#endif
+    }
+    *capacity = (uint32_t)LV_MIN(limit, UINT32_MAX);
+    *free_pct = limit > mem.used ? (uint32_t)((limit - mem.used) * 100 / limit) : 0;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    *capacity = (uint32_t)mon.total_size;
+    *free_pct = mon.total_size ? (uint32_t)((uint64_t)mon.free_size * 100 / mon.total_size) : 100;
+#endif
+}
+
+#if LV_PORT_CACHE
+
+#define LVGL_CACHE_STEP_DIV     8                // budgets move in steps of this fraction of the total
+#define LVGL_CACHE_MISS_PCT     10               // a full cache missing more often than this grows
+#define LVGL_CACHE_IDLE_PCT     50               // a cache filled less than this shrinks
+#define LVGL_CACHE_ENTRY_BYTES  (16 * 1024)      // v8: decoded image size assumed until one was seen
+#define LVGL_CACHE_ENTRIES_MAX  64               // v8: image cache slots
+#define LVGL_CACHE_DECODERS     8                // v8: decoders whose opens are counted
+#define LVGL_CACHE_HEADER_BYTES 64               // v9: one image header cache entry
+
+typedef enum {
+    LVGL_CACHE_IMAGE = 0,
+#if LVGL_USE_V8 == 1
+    LVGL_CACHE_GRADIENT,
+#else
+    LVGL_CACHE_HEADER,
+#endif
+#if LV_PORT_GLYPH_CACHE
+    LVGL_CACHE_GLYPH,  // lvgl_port_glyph.hpp, in LVGL's heap like the others
+#endif
+    LVGL_CACHE_COUNT,
+} lvgl_cache_id_t;
+
+typedef struct {
+    const char *name;
+    bool fixed;       // sized once from lv_conf.h, not rebalanced
+    uint32_t budget;  // [bytes]
+    uint32_t min;     // below this the cache is off
+    uint32_t max;     // 0: no limit
+    std::atomic<uint32_t> lookups;
+    std::atomic<uint32_t> misses;
+    uint32_t period_lookups;  // at the start of the period
+    uint32_t period_misses;
+    uint8_t hit_pct;
+} lvgl_cache_t;
+
+static lvgl_cache_t caches[LVGL_CACHE_COUNT];
+static uint32_t cache_total;  // budget of all caches together
+static uint32_t cache_tick;
+
+#if LVGL_USE_V8 == 1
+typedef struct {
+    lv_img_decoder_t *decoder;
+    lv_img_decoder_open_f_t open_cb;
+    lv_img_decoder_close_f_t close_cb;
+} lvgl_cache_decoder_t;
+
+static lvgl_cache_decoder_t cache_decoders[LVGL_CACHE_DECODERS];
+static uint32_t cache_decoder_cnt;
+static uint32_t image_bytes;                                 // decoded images held open
+static uint32_t image_entry_bytes = LVGL_CACHE_ENTRY_BYTES;  // running average of one
+static uint16_t image_entries     = LV_IMG_CACHE_DEF_SIZE;
+
+static const lvgl_cache_decoder_t *lvgl_cache_decoder(lv_img_decoder_t *decoder)
+{
+    for (uint32_t i = 0; i < cache_decoder_cnt; i++) {
+        if (cache_decoders[i].decoder == decoder) {
+            return &cache_decoders[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t lvgl_cache_decoded_bytes(const lv_img_decoder_dsc_t *dsc)
+{
+    // Images in flash are opened in place, line by line decoders hold no image at all
+    if (dsc->img_data == NULL ||
+        (dsc->src_type == LV_IMG_SRC_VARIABLE && dsc->img_data == ((const lv_img_dsc_t *)dsc->src)->data)) {
+        return 0;
+    }
+    return (uint32_t)dsc->header.w * dsc->header.h * lv_img_cf_get_px_size(dsc->header.cf) / 8;
+}
+
+static lv_res_t lvgl_cache_decoder_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    const lv_res_t res = lvgl_cache_decoder(decoder)->open_cb(decoder, dsc);
+    if (res == LV_RES_OK) {
+        // LVGL opens an image only when its cache does not hold it
+        caches[LVGL_CACHE_IMAGE].misses++;
+        const uint32_t bytes = lvgl_cache_decoded_bytes(dsc);
+        if (bytes) {
+            image_bytes += bytes;
+            image_entry_bytes = (image_entry_bytes * 7 + bytes) / 8;
+        }
+    }
+    return res;
+}
+
+static void lvgl_cache_decoder_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    const uint32_t bytes = lvgl_cache_decoded_bytes(dsc);
+    image_bytes -= LV_MIN(bytes, image_bytes);
+    const lvgl_cache_decoder_t *d = lvgl_cache_decoder(decoder);
+    if (d->close_cb) {
+        d->close_cb(decoder, dsc);
+    }
+}
+
+// Decoders added after lvgl_port_init() are picked up on the next period
+static void lvgl_cache_wrap_decoders(void)
+{
+    lv_img_decoder_t *decoder;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+        if (decoder->open_cb == NULL || decoder->open_cb == lvgl_cache_decoder_open) {
+            continue;
+        }
+        // A deleted decoder's slot is reused by the one allocated in its place
+        lvgl_cache_decoder_t *d = (lvgl_cache_decoder_t *)lvgl_cache_decoder(decoder);
+        if (d == NULL) {
+            if (cache_decoder_cnt == LVGL_CACHE_DECODERS) {
+                return;
+            }
+            d = &cache_decoders[cache_decoder_cnt++];
+        }
+        d->decoder        = decoder;
+        d->open_cb        = decoder->open_cb;
+        d->close_cb       = decoder->close_cb;
+        decoder->open_cb  = lvgl_cache_decoder_open;
+        decoder->close_cb = lvgl_cache_decoder_close;
+    }
+}
+
+// Every image drawn looks the cache up first
+static lv_res_t lvgl_cache_draw_img(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords,
+                                    const void *src)
+{
+    (void)draw_ctx;
+    (void)dsc;
+    (void)coords;
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_SYMBOL) {
+        caches[LVGL_CACHE_IMAGE].lookups++;
+    }
+    return LV_RES_INV;  // LVGL goes on with its own cached decode and draw
+}
+
+static uint32_t lvgl_cache_lv_used(lvgl_cache_id_t id)
+{
+    return id == LVGL_CACHE_IMAGE ? image_bytes : 0;  // the gradient cache does not tell
+}
+
+static void lvgl_cache_lv_apply(lvgl_cache_id_t id)
+{
+    if (id == LVGL_CACHE_IMAGE) {
+        // With caching compiled in, LVGL cannot draw images without a slot
+        uint32_t entries = caches[id].budget / LV_MAX(image_entry_bytes, 1024);
+        entries          = LV_MAX(1, LV_MIN(entries, LVGL_CACHE_ENTRIES_MAX));
+        if (entries != image_entries) {
+            // Drops the cached images, budgets only move in coarse steps
+            lv_img_cache_set_size((uint16_t)entries);
+            image_entries = (uint16_t)entries;
+        }
+    } else {
+        lv_gradient_set_cache_size(caches[id].budget);
+    }
+}
+
+static void lvgl_cache_lv_evict(lvgl_cache_id_t id)
+{
+    if (id == LVGL_CACHE_IMAGE) {
+        lv_img_cache_invalidate_src(NULL);
+    } else {
+        lv_gradient_set_cache_size(caches[id].budget);  // starts over empty
+    }
+}
+#else
+static lv_cache_class_t cache_classes[LVGL_CACHE_COUNT];  // the caches' own classes with counting lookups
+static const lv_cache_class_t *cache_orig[LVGL_CACHE_COUNT];
+
+static lv_cache_t *lvgl_cache_obj(lvgl_cache_id_t id)
+{
+    return id == LVGL_CACHE_IMAGE ? LV_GLOBAL_DEFAULT()->img_cache : LV_GLOBAL_DEFAULT()->img_header_cache;
+}
+
+static lvgl_cache_id_t lvgl_cache_id(const lv_cache_t *cache)
+{
+    return cache == LV_GLOBAL_DEFAULT()->img_cache ? LVGL_CACHE_IMAGE : LVGL_CACHE_HEADER;
+}
+
+// Draw threads call in with the cache's lock held. A hit is a lookup, a miss is the entry added after it.
+static lv_cache_entry_t *lvgl_cache_get(lv_cache_t *cache, const void *key, void *user_data)
+{
+    const lvgl_cache_id_t id = lvgl_cache_id(cache);
+    lv_cache_entry_t *entry  = cache_orig[id]->get_cb(cache, key, user_data);
+    if (entry) {
+        caches[id].lookups++;
+    }
+    return entry;
+}
+
+static lv_cache_entry_t *lvgl_cache_add(lv_cache_t *cache, const void *key, void *user_data)
+{
+    const lvgl_cache_id_t id = lvgl_cache_id(cache);
+    caches[id].lookups++;
+    caches[id].misses++;
+    return cache_orig[id]->add_cb(cache, key, user_data);
+}
+
+static void lvgl_cache_wrap(lvgl_cache_id_t id)
+{
+    lv_cache_t *cache = lvgl_cache_obj(id);
+    if (cache == NULL || cache->clz == &cache_classes[id]) {
+        return;
+    }
+    cache_orig[id]           = cache->clz;
+    cache_classes[id]        = *cache->clz;
+    cache_classes[id].get_cb = lvgl_cache_get;
+    cache_classes[id].add_cb = lvgl_cache_add;
+    cache->clz               = &cache_classes[id];
+}
+
+static uint32_t lvgl_cache_lv_used(lvgl_cache_id_t id)
+{
+    lv_cache_t *cache = lvgl_cache_obj(id);
+    if (cache == NULL) {
+        return 0;
+    }
+    const uint32_t size = (uint32_t)lv_cache_get_size(cache, NULL);
+    return id == LVGL_CACHE_IMAGE ? size : size * LVGL_CACHE_HEADER_BYTES;
+}
+
+static void lvgl_cache_lv_apply(lvgl_cache_id_t id)
+{
+    if (id == LVGL_CACHE_IMAGE) {
+        lv_image_cache_resize(caches[id].budget, true);
+    } else {
+        lv_image_header_cache_resize(caches[id].budget / LVGL_CACHE_HEADER_BYTES, true);
+    }
+}
+
+static void lvgl_cache_lv_evict(lvgl_cache_id_t id)
+{
+    if (id == LVGL_CACHE_IMAGE) {
+        lv_image_cache_drop(NULL);
+    } else {
+        lv_image_header_cache_drop(NULL);
+    }
+}
+#endif
+
+static uint32_t lvgl_cache_used(lvgl_cache_id_t id)
+{
+#if LV_PORT_GLYPH_CACHE
+    if (id == LVGL_CACHE_GLYPH) {
+        lvgl_port_glyph_stats_t glyph;
+        lvgl_port_glyph_get_stats(&glyph);
+        return glyph.used;
+    }
+#endif
+    return lvgl_cache_lv_used(id);
+}
+
+static void lvgl_cache_apply(lvgl_cache_id_t id)
+{
+#if LV_PORT_GLYPH_CACHE
+    if (id == LVGL_CACHE_GLYPH) {
+        lvgl_port_glyph_set_budget(caches[id].budget);
+        return;
+    }
+#endif
+    lvgl_cache_lv_apply(id);
+}
+
+static void lvgl_cache_evict(lvgl_cache_id_t id)
+{
+#if LV_PORT_GLYPH_CACHE
+    if (id == LVGL_CACHE_GLYPH) {
+        lvgl_port_glyph_clear();
+        return;
+    }
+#endif
+    lvgl_cache_lv_evict(id);
+}
+
+// The glyph cache counts its own lookups
+static void lvgl_cache_count(void)
+{
+#if LV_PORT_GLYPH_CACHE
+    lvgl_port_glyph_stats_t glyph;
+    lvgl_port_glyph_get_stats(&glyph);
+    caches[LVGL_CACHE_GLYPH].lookups = glyph.lookups;
+    caches[LVGL_CACHE_GLYPH].misses  = glyph.lookups - glyph.hits;
+#endif
+}
+
+extern "C" void lvgl_port_cache_start(void)
+{
+    uint32_t capacity, free_pct;
+    lvgl_port_cache_heap(&capacity, &free_pct);
+    cache_total = (uint32_t)LV_MIN((uint64_t)LV_PORT_CACHE_BUDGET, (uint64_t)capacity * LV_PORT_CACHE_HEAP_PCT / 100);
+
+    uint32_t glyph_budget = 0;
+#if LV_PORT_GLYPH_CACHE
+    // Starts at a quarter of the total and grows up to LV_PORT_GLYPH_CACHE_SIZE while labels keep missing
+    caches[LVGL_CACHE_GLYPH].name   = "glyph";
+    caches[LVGL_CACHE_GLYPH].max    = LV_PORT_GLYPH_CACHE_SIZE;
+    caches[LVGL_CACHE_GLYPH].budget = LV_MIN(LV_PORT_GLYPH_CACHE_SIZE, cache_total / 4);
+    glyph_budget                    = caches[LVGL_CACHE_GLYPH].budget;
+    lvgl_cache_apply(LVGL_CACHE_GLYPH);
+#endif
+
+    caches[LVGL_CACHE_IMAGE].name = "image";
+#if LVGL_USE_V8 == 1
+    caches[LVGL_CACHE_GRADIENT].name   = "gradient";
+    caches[LVGL_CACHE_GRADIENT].fixed  = true;
+    caches[LVGL_CACHE_GRADIENT].budget = LV_MIN(LV_GRAD_CACHE_DEF_SIZE, cache_total / 4);
+    caches[LVGL_CACHE_IMAGE].budget    = (cache_total - caches[LVGL_CACHE_GRADIENT].budget - glyph_budget) / 2;
+    if (caches[LVGL_CACHE_GRADIENT].budget != LV_GRAD_CACHE_DEF_SIZE) {
+        lvgl_cache_apply(LVGL_CACHE_GRADIENT);
+    }
+
+    lvgl_cache_wrap_decoders();
+    lv_draw_ctx_t *draw_ctx = lv_disp_get_default()->driver->draw_ctx;
+    if (draw_ctx->draw_img == NULL) {
+        draw_ctx->draw_img = lvgl_cache_draw_img;
+    }
+#else
+    caches[LVGL_CACHE_HEADER].name   = "image_header";
+    caches[LVGL_CACHE_HEADER].fixed  = true;
+    caches[LVGL_CACHE_HEADER].budget = LV_IMAGE_HEADER_CACHE_DEF_CNT * LVGL_CACHE_HEADER_BYTES;
+
+    // LVGL fails to decode an image larger than its cache, keep the cache off unless a full screen image fits
+    lv_display_t *disp             = lv_display_get_default();
+    caches[LVGL_CACHE_IMAGE].min   = lv_display_get_horizontal_resolution(disp) *
+                                   lv_display_get_vertical_resolution(disp) * 4;
+    const uint32_t taken           = caches[LVGL_CACHE_HEADER].budget + glyph_budget;
+    const uint32_t room            = cache_total > taken ? cache_total - taken : 0;
+    caches[LVGL_CACHE_IMAGE].budget = room < caches[LVGL_CACHE_IMAGE].min ? 0 : LV_MAX(room / 2, caches[LVGL_CACHE_IMAGE].min);
+    if (caches[LVGL_CACHE_IMAGE].budget == 0) {
+        caches[LVGL_CACHE_IMAGE].fixed = true;
+        LV_LOG_WARN("lvgl_port_cache: %u bytes cannot hold a screen sized image, image cache off", (unsigned)room);
+    }
+
+    lvgl_cache_wrap(LVGL_CACHE_IMAGE);
+    lvgl_cache_wrap(LVGL_CACHE_HEADER);
+#endif
+    lvgl_cache_apply(LVGL_CACHE_IMAGE);
+    cache_tick = lv_tick_get();
+}
+
+extern "C" void lvgl_port_cache_step(uint32_t tick)
+{
+    // Only runs while the GUI thread does, a parked UI looks nothing up
+    if (tick - cache_tick < LV_PORT_CACHE_PERIOD_MS) {
+        return;
+    }
+    cache_tick = tick;
+#if LVGL_USE_V8 == 1
+    lvgl_cache_wrap_decoders();
+#endif
+    lvgl_cache_count();
+
+    uint32_t assigned = 0;
+    uint32_t period_lookups[LVGL_CACHE_COUNT], period_misses[LVGL_CACHE_COUNT];
+    for (int i = 0; i < LVGL_CACHE_COUNT; i++) {
+        lvgl_cache_t *c   = &caches[i];
+        const uint32_t l  = c->lookups, m = c->misses;
+        period_lookups[i] = l - c->period_lookups;
+        period_misses[i]  = LV_MIN(m - c->period_misses, period_lookups[i]);
+        c->period_lookups = l;
+        c->period_misses  = m;
+        if (period_lookups[i]) {
+            c->hit_pct = (uint8_t)((period_lookups[i] - period_misses[i]) * 100ULL / period_lookups[i]);
+        }
+        assigned += c->budget;
+    }
+
+    uint32_t capacity, free_pct;
+    lvgl_port_cache_heap(&capacity, &free_pct);
+    if (free_pct < LV_PORT_CACHE_LOW_MEM_PCT) {
+        // Memory pressure, hand the cached memory back to the app
+        for (int i = 0; i < LVGL_CACHE_COUNT; i++) {
+            lvgl_cache_t *c = &caches[i];
+            c->budget /= 2;
+            if (c->budget < c->min) {
+                c->budget = 0;
+            }
+            lvgl_cache_evict((lvgl_cache_id_t)i);
+            lvgl_cache_apply((lvgl_cache_id_t)i);
+        }
+        LV_LOG_WARN("lvgl_port_cache: %u%% of the heap free, caches evicted", (unsigned)free_pct);
+        return;
+    }
+
+    // Full caches that keep missing take from the reserve, caches with idle memory give back to it
+    const uint32_t step = LV_MAX(cache_total / LVGL_CACHE_STEP_DIV, 1);
+    uint32_t reserve    = cache_total > assigned ? cache_total - assigned : 0;
+    for (int i = 0; i < LVGL_CACHE_COUNT; i++) {
+        lvgl_cache_t *c = &caches[i];
+        if (c->fixed) {
+            continue;
+        }
+        const uint32_t used  = lvgl_cache_used((lvgl_cache_id_t)i);
+        const bool full      = used + LV_MIN(step, c->budget) >= c->budget;
+        const bool missing   = period_misses[i] * 100ULL > period_lookups[i] * (uint64_t)LVGL_CACHE_MISS_PCT;
+        const uint32_t prev  = c->budget;
+        if (c->budget < c->min) {
+            // Turned off under memory pressure, back on once there is room
+            if (reserve >= c->min) {
+                c->budget = c->min;
+            }
+        } else if (missing && full && reserve && (c->max == 0 || c->budget < c->max)) {
+            c->budget += LV_MIN(LV_MIN(step, reserve), c->max ? c->max - c->budget : UINT32_MAX);
+        } else if (used * 100ULL < c->budget * (uint64_t)LVGL_CACHE_IDLE_PCT && c->budget >= c->min + step) {
+            c->budget -= step;
+        }
+        if (c->budget != prev) {
+            reserve = reserve + prev - c->budget;
+            lvgl_cache_apply((lvgl_cache_id_t)i);
+        }
+    }
+}
+
+extern "C" uint32_t lvgl_port_cache_get_stats(lvgl_port_cache_stat_t *stats, uint32_t max)
+{
+    lvgl_cache_count();
+    const uint32_t n = LV_MIN(max, (uint32_t)LVGL_CACHE_COUNT);
+    for (uint32_t i = 0; i < n; i++) {
+        const lvgl_cache_t *c = &caches[i];
+        stats[i].name         = c->name;
+        stats[i].budget       = c->budget;
+        stats[i].used         = lvgl_cache_used((lvgl_cache_id_t)i);
+        stats[i].lookups      = c->lookups;
+        stats[i].misses       = c->misses;
+        stats[i].hit_pct      = c->hit_pct;
+    }
+    return n;
+}
+
+extern "C" void lvgl_port_cache_trim(void)
+{
+    for (int i = 0; i < LVGL_CACHE_COUNT; i++) {
+        lvgl_cache_evict((lvgl_cache_id_t)i);
+    }
+}
+
+#else
+
+extern "C" uint32_t lvgl_port_cache_get_stats(lvgl_port_cache_stat_t *stats, uint32_t max)
+{
+    (void)stats;
+    (void)max;
+    return 0;
+}
+
+extern "C" void lvgl_port_cache_trim(void)
+{
+}
+
+extern "C" void lvgl_port_cache_start(void)
+{
+}
+
+extern "C" void lvgl_port_cache_step(uint32_t tick)
+{
+    (void)tick;
+}
+
+#endif  // LV_PORT_CACHE
@@ -0,0 +1,57 @@
+#ifndef __LVGL_PORT_CACHE_HPP__
+#define __LVGL_PORT_CACHE_HPP__
+
+#include "lvgl.h"
+
+// 1: size LVGL's render caches within LV_PORT_CACHE_BUDGET (lv_conf.h, per board profile) and rebalance them
+#ifndef LV_PORT_CACHE
+#define LV_PORT_CACHE (LV_PORT_CACHE_BUDGET > 0)
+#endif
+
+// Rebalancing period [ms]
+#ifndef LV_PORT_CACHE_PERIOD_MS
+#define LV_PORT_CACHE_PERIOD_MS 1000
+#endif
+
+// Share of LVGL's heap the caches may take [%]
+#ifndef LV_PORT_CACHE_HEAP_PCT
+#define LV_PORT_CACHE_HEAP_PCT 50
+#endif
+
+// Below this much free LVGL heap [%] the caches are evicted and their budgets halved
+#ifndef LV_PORT_CACHE_LOW_MEM_PCT
+#define LV_PORT_CACHE_LOW_MEM_PCT 10
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *name;  // "image", "gradient" (v8), "image_header" (v9), "glyph" (LV_PORT_GLYPH_CACHE)
+    uint32_t budget;   // [bytes]
+    uint32_t used;     // [bytes], as far as the cache tells
+    uint32_t lookups;  // since start, 0 for caches without statistics
+    uint32_t misses;
+    uint8_t hit_pct;   // over the latest period
+} lvgl_port_cache_stat_t;
+
+// Copies the state of up to max caches, returns how many. Call with the GUI lock held
+uint32_t lvgl_port_cache_get_stats(lvgl_port_cache_stat_t *stats, uint32_t max);
+
+// Drops every cached entry, e.g. before a large allocation. Call with the GUI lock held
+void lvgl_port_cache_trim(void);
+
+// LVGL heap caches may take a share of [bytes] and how much of it is free [%], also without LV_PORT_CACHE.
+// Call with the GUI lock held
+void lvgl_port_cache_heap(uint32_t *capacity, uint32_t *free_pct);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_cache_start(void);
+void lvgl_port_cache_step(uint32_t tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_CACHE_HPP__
@@ -0,0 +1,531 @@
+#include "lvgl_port_fs.hpp"
+#include <cstdio>   // for fopen, fread, snprintf
+#include <cstdlib>  // for malloc
+#include <cstring>  // for memcpy, strcmp
+
+#if LV_PORT_FS
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+#if LV_PORT_FS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if __has_include(<dirent.h>)
+#include <dirent.h>
+#define LVGL_FS_DIRS 1
+#else
+#define LVGL_FS_DIRS 0
+#endif
+
+#if LVGL_USE_V9 == 1 && LV_USE_OS != LV_OS_NONE
+#include <mutex>
+#define LVGL_FS_LOCKED 1  // the draw threads decode images from files too
+#else
+#define LVGL_FS_LOCKED 0
+#endif
+
+#if LVGL_USE_V8 == 1
+#define LVGL_FS_ALLOC lv_mem_alloc
+#define LVGL_FS_FREE  lv_mem_free
+#else
+#define LVGL_FS_ALLOC lv_malloc
+#define LVGL_FS_FREE  lv_free
+#endif
+
+#define LVGL_FS_PATH_MAX 256
+
+static lv_fs_drv_t fs_drv;
+static lvgl_port_fs_stats_t fs_stats;
+#if LVGL_FS_LOCKED
+static std::mutex fs_mutex;
+#define LVGL_FS_LOCK() std::lock_guard<std::mutex> lvgl_fs_guard(fs_mutex)
+#else
+#define LVGL_FS_LOCK()
+#endif
+
+static bool lvgl_fs_path(char *buf, const char *path)
+{
+    return snprintf(buf, LVGL_FS_PATH_MAX, "%s%s", LV_PORT_FS_ROOT, path) < LVGL_FS_PATH_MAX;
+}
+
+#if LV_PORT_FS_MMAP
+typedef struct {
+    const uint8_t *map;  // NULL for an empty file
+    uint32_t size;
+    uint32_t pos;
+} lvgl_fs_file_t;
+
+// An empty file maps to NULL but still succeeds
+static bool lvgl_fs_mmap(const char *path, const uint8_t **map, size_t *size)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        *size = (size_t)st.st_size;
+        data  = *size ? mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    }
+    close(fd);  // the mapping stays
+    *map = data == MAP_FAILED ? NULL : (const uint8_t *)data;
+    return data != MAP_FAILED;
+}
+
+static void *lvgl_fs_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
+{
+    (void)drv;
+    char full[LVGL_FS_PATH_MAX];
+    if (mode != LV_FS_MODE_RD || !lvgl_fs_path(full, path)) {
+        return NULL;
+    }
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)LVGL_FS_ALLOC(sizeof(lvgl_fs_file_t));
+    if (f == NULL) {
+        return NULL;
+    }
+    size_t size = 0;
+    if (!lvgl_fs_mmap(full, &f->map, &size)) {
+        LVGL_FS_FREE(f);
+        return NULL;
+    }
+    f->size = (uint32_t)size;
+    f->pos  = 0;
+    LVGL_FS_LOCK();
+    fs_stats.opens++;
+    return f;
+}
+
+static lv_fs_res_t lvgl_fs_close(lv_fs_drv_t *drv, void *file_p)
+{
+    (void)drv;
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)file_p;
+    if (f->map) {
+        munmap((void *)f->map, f->size);
+    }
+    LVGL_FS_FREE(f);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t lvgl_fs_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    (void)drv;
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)file_p;
+    *br               = LV_MIN(btr, f->size - f->pos);
+    if (*br) {
+        memcpy(buf, f->map + f->pos, *br);
+    }
+    f->pos += *br;
+    LVGL_FS_LOCK();
+    fs_stats.bytes_read += *br;
+    return LV_FS_RES_OK;
+}
+#else
+typedef struct {
+    FILE *fp;
+    uint32_t id;  // of the file's blocks, the cache outlives the open file
+    uint32_t size;
+    uint32_t pos;         // LVGL's position
+    uint32_t dev_pos;     // position of fp
+    uint32_t next_block;  // a read of this block continues a sequential run
+} lvgl_fs_file_t;
+
+typedef struct {
+    uint32_t id;  // 0: free
+    uint32_t index;
+    uint32_t len;  // short for the last block of a file
+    uint32_t used;  // LRU stamp
+} lvgl_fs_block_t;
+
+// Files whose blocks can be cached at the same time
+#define LVGL_FS_IDS_MAX 32
+
+typedef struct {
+    char *path;  // NULL: free
+    uint32_t size;
+    uint32_t id;
+    uint32_t used;  // LRU stamp
+} lvgl_fs_id_t;
+
+static lvgl_fs_block_t fs_blocks[LV_PORT_FS_BLOCKS];
+static uint8_t *fs_block_data;  // LV_PORT_FS_BLOCKS * LV_PORT_FS_BLOCK_SIZE, allocated by the first open
+static uint32_t fs_stamp;
+static lvgl_fs_id_t fs_ids[LVGL_FS_IDS_MAX];
+static uint32_t fs_last_id;
+
+// Id of the file's cached blocks by full path and size. Ids are never reused: a file dropped from the table
+// takes its blocks with it and gets a new id when it is opened again.
+static uint32_t lvgl_fs_file_id(const char *path, uint32_t size)
+{
+    lvgl_fs_id_t *victim = NULL;
+    for (uint32_t i = 0; i < LVGL_FS_IDS_MAX; i++) {
+        lvgl_fs_id_t *e = &fs_ids[i];
+        if (e->path && e->size == size && strcmp(e->path, path) == 0) {
+            e->used = ++fs_stamp;
+            return e->id;
+        }
+        if (victim == NULL || (victim->path && (e->path == NULL || e->used < victim->used))) {
+            victim = e;
+        }
+    }
+    if (victim->path) {
+        for (uint32_t i = 0; i < LV_PORT_FS_BLOCKS; i++) {
+            if (fs_blocks[i].id == victim->id) {
+                fs_blocks[i].id = 0;
+            }
+        }
+        free(victim->path);
+    }
+    const size_t len = strlen(path) + 1;
+    victim->path     = (char *)malloc(len);
+    if (victim->path) {
+        memcpy(victim->path, path, len);  // without it the blocks are cached until the file is closed
+    }
+    victim->size = size;
+    victim->id   = ++fs_last_id ? fs_last_id : ++fs_last_id;  // 0 marks free blocks
+    victim->used = ++fs_stamp;
+    return victim->id;
+}
+
+// The cache takes LV_PORT_FS_BLOCKS * LV_PORT_FS_BLOCK_SIZE bytes, apps that never open a file do not pay for it
+static bool lvgl_fs_cache_init(void)
+{
+    if (fs_block_data) {
+        return true;
+    }
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && defined(BOARD_HAS_PSRAM)
+    fs_block_data = (uint8_t *)heap_caps_malloc(LV_PORT_FS_BLOCKS * LV_PORT_FS_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+#else
+    fs_block_data = (uint8_t *)malloc(LV_PORT_FS_BLOCKS * LV_PORT_FS_BLOCK_SIZE);
+#endif
+    if (fs_block_data == NULL) {
+        printf("ERROR: Failed to allocate the %u byte file block cache\n",
+               (unsigned)(LV_PORT_FS_BLOCKS * LV_PORT_FS_BLOCK_SIZE));
+        return false;
+    }
+    return true;
+}
+
+static bool lvgl_fs_device_read(lvgl_fs_file_t *f, uint32_t pos, void *buf, uint32_t len, uint32_t *got)
+{
+    if (f->dev_pos != pos) {
+        if (fseek(f->fp, (long)pos, SEEK_SET) != 0) {
+            return false;
+        }
+        fs_stats.device_seeks++;
+    }
+    *got      = (uint32_t)fread(buf, 1, len, f->fp);
+    f->dev_pos = pos + *got;
+    fs_stats.device_bytes += *got;
+    return *got == len;
+}
+
+static lvgl_fs_block_t *lvgl_fs_block_find(uint32_t id, uint32_t index)
+{
+    for (uint32_t i = 0; i < LV_PORT_FS_BLOCKS; i++) {
+        if (fs_blocks[i].id == id && fs_blocks[i].index == index) {
+            return &fs_blocks[i];
+        }
+    }
+    return NULL;
+}
+
+static lvgl_fs_block_t *lvgl_fs_block_victim(void)
+{
+    lvgl_fs_block_t *victim = &fs_blocks[0];
+    for (uint32_t i = 1; i < LV_PORT_FS_BLOCKS && victim->id; i++) {
+        if (fs_blocks[i].id == 0 || fs_blocks[i].used < victim->used) {
+            victim = &fs_blocks[i];
+        }
+    }
+    return victim;
+}
+
+// Reads a missing block, and the blocks after it when the file is read sequentially
+static lvgl_fs_block_t *lvgl_fs_block_load(lvgl_fs_file_t *f, uint32_t index)
+{
+    const uint32_t last  = (f->size - 1) / LV_PORT_FS_BLOCK_SIZE;
+    const uint32_t ahead = index == f->next_block ? LV_PORT_FS_READ_AHEAD : 0;
+    lvgl_fs_block_t *first = NULL;
+    for (uint32_t i = index; i <= LV_MIN(index + ahead, last); i++) {
+        if (i != index && lvgl_fs_block_find(f->id, i)) {
+            break;
+        }
+        lvgl_fs_block_t *b = lvgl_fs_block_victim();
+        uint8_t *data      = fs_block_data + (b - fs_blocks) * LV_PORT_FS_BLOCK_SIZE;
+        const uint32_t pos = i * LV_PORT_FS_BLOCK_SIZE;
+        uint32_t got;
+        b->id = 0;
+        if (!lvgl_fs_device_read(f, pos, data, LV_MIN(LV_PORT_FS_BLOCK_SIZE, f->size - pos), &got)) {
+            break;
+        }
+        b->id    = f->id;
+        b->index = i;
+        b->len   = got;
+        b->used  = ++fs_stamp;
+        if (i == index) {
+            first = b;
+        } else {
+            fs_stats.read_ahead++;
+        }
+    }
+    return first;
+}
+
+static void *lvgl_fs_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
+{
+    (void)drv;
+    char full[LVGL_FS_PATH_MAX];
+    if (mode != LV_FS_MODE_RD || !lvgl_fs_path(full, path)) {
+        return NULL;
+    }
+    LVGL_FS_LOCK();
+    if (!lvgl_fs_cache_init()) {
+        return NULL;
+    }
+    FILE *fp = fopen(full, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)LVGL_FS_ALLOC(sizeof(lvgl_fs_file_t));
+    if (f == NULL || fseek(fp, 0, SEEK_END) != 0) {
+        LVGL_FS_FREE(f);
+        fclose(fp);
+        return NULL;
+    }
+    f->fp         = fp;
+    f->size       = (uint32_t)ftell(fp);
+    f->dev_pos    = f->size;
+    f->pos        = 0;
+    f->next_block = 0;
+    f->id         = lvgl_fs_file_id(full, f->size);
+    fs_stats.opens++;
+    return f;
+}
+
+static lv_fs_res_t lvgl_fs_close(lv_fs_drv_t *drv, void *file_p)
+{
+    (void)drv;
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)file_p;
+    fclose(f->fp);
+    LVGL_FS_FREE(f);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t lvgl_fs_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    (void)drv;
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)file_p;
+    uint8_t *out      = (uint8_t *)buf;
+    btr               = LV_MIN(btr, f->size - f->pos);
+    *br               = 0;
+    LVGL_FS_LOCK();
+    while (btr) {
+        const uint32_t index = f->pos / LV_PORT_FS_BLOCK_SIZE;
+        const uint32_t ofs   = f->pos % LV_PORT_FS_BLOCK_SIZE;
+        uint32_t n;
+
+        // Reads of half the cache or more go straight to the buffer instead of flushing the cache
+        if (ofs == 0 && btr >= LV_PORT_FS_BLOCKS / 2 * LV_PORT_FS_BLOCK_SIZE && !lvgl_fs_block_find(f->id, index)) {
+            n = btr - btr % LV_PORT_FS_BLOCK_SIZE;
+            uint32_t got;
+            const bool ok = lvgl_fs_device_read(f, f->pos, out, n, &got);
+            fs_stats.misses += (got + LV_PORT_FS_BLOCK_SIZE - 1) / LV_PORT_FS_BLOCK_SIZE;
+            n = got;
+            if (!ok && n == 0) {
+                break;
+            }
+        } else {
+            lvgl_fs_block_t *b = lvgl_fs_block_find(f->id, index);
+            if (b) {
+                fs_stats.hits++;
+                b->used = ++fs_stamp;
+            } else {
+                fs_stats.misses++;
+                b = lvgl_fs_block_load(f, index);
+                if (b == NULL) {
+                    break;
+                }
+            }
+            n = LV_MIN(b->len - ofs, btr);
+            memcpy(out, fs_block_data + (b - fs_blocks) * LV_PORT_FS_BLOCK_SIZE + ofs, n);
+        }
+        f->next_block = (f->pos + n - 1) / LV_PORT_FS_BLOCK_SIZE + 1;
+        f->pos += n;
+        out += n;
+        *br += n;
+        btr -= n;
+    }
+    fs_stats.bytes_read += *br;
+    return *br || btr == 0 ? LV_FS_RES_OK : LV_FS_RES_HW_ERR;
+}
+#endif
+
+static lv_fs_res_t lvgl_fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+    (void)drv;
+    lvgl_fs_file_t *f = (lvgl_fs_file_t *)file_p;
+    int64_t to        = pos;
+    if (whence == LV_FS_SEEK_CUR) {
+        to += f->pos;
+    } else if (whence == LV_FS_SEEK_END) {
+        to += f->size;
+    }
+    f->pos = (uint32_t)LV_MIN(to, (int64_t)f->size);
+    LVGL_FS_LOCK();
+    fs_stats.seeks++;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t lvgl_fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    (void)drv;
+    *pos_p = ((lvgl_fs_file_t *)file_p)->pos;
+    return LV_FS_RES_OK;
+}
+
+#if LVGL_FS_DIRS
+static void *lvgl_fs_dir_open(lv_fs_drv_t *drv, const char *path)
+{
+    (void)drv;
+    char full[LVGL_FS_PATH_MAX];
+    return lvgl_fs_path(full, path) ? opendir(full) : NULL;
+}
+
+// Directories are listed with a leading '/', like LVGL's own drivers do
+static lv_fs_res_t lvgl_fs_dir_read_entry(void *rddir_p, char *fn, uint32_t fn_len)
+{
+    struct dirent *entry;
+    do {
+        entry = readdir((DIR *)rddir_p);
+        if (entry == NULL) {
+            fn[0] = '\0';
+            return LV_FS_RES_OK;
+        }
+    } while (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0);
+    snprintf(fn, fn_len, entry->d_type == DT_DIR ? "/%s" : "%s", entry->d_name);
+    return LV_FS_RES_OK;
+}
+
+#if LVGL_USE_V8 == 1
+static lv_fs_res_t lvgl_fs_dir_read(lv_fs_drv_t *drv, void *rddir_p, char *fn)
+{
+    (void)drv;
+    return lvgl_fs_dir_read_entry(rddir_p, fn, LVGL_FS_PATH_MAX);
+}
+#else
+static lv_fs_res_t lvgl_fs_dir_read(lv_fs_drv_t *drv, void *rddir_p, char *fn, uint32_t fn_len)
+{
+    (void)drv;
+    return lvgl_fs_dir_read_entry(rddir_p, fn, fn_len);
+}
+#endif
+
+static lv_fs_res_t lvgl_fs_dir_close(lv_fs_drv_t *drv, void *rddir_p)
+{
+    (void)drv;
+    closedir((DIR *)rddir_p);
+    return LV_FS_RES_OK;
+}
+#endif
+
+extern "C" const void *lvgl_port_fs_map(const char *path, size_t *size)
+{
+    char full[LVGL_FS_PATH_MAX];
+    *size = 0;
+    if (!lvgl_fs_path(full, path)) {
+        return NULL;
+    }
+#if LV_PORT_FS_MMAP
+    const uint8_t *map;
+    return lvgl_fs_mmap(full, &map, size) ? map : NULL;
+#else
+    FILE *fp = fopen(full, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    const size_t len = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && defined(BOARD_HAS_PSRAM)
+    void *data = heap_caps_malloc(len ? len : 1, MALLOC_CAP_SPIRAM);
+#else
+    void *data = malloc(len ? len : 1);
+#endif
+    const bool ok = data && fread(data, 1, len, fp) == len;
+    fclose(fp);
+    if (!ok) {
+        free(data);
+        return NULL;
+    }
+    *size = len;
+    return data;
+#endif
+}
+
+extern "C" void lvgl_port_fs_unmap(const void *data, size_t size)
+{
+#if LV_PORT_FS_MMAP
+    if (data && size) {
+        munmap((void *)data, size);
+    }
+#else
+    (void)size;
+    free((void *)data);
+#endif
+}
+
+extern "C" void lvgl_port_fs_get_stats(lvgl_port_fs_stats_t *stats)
+{
+    LVGL_FS_LOCK();
+    *stats         = fs_stats;
+    const uint32_t blocks = fs_stats.hits + fs_stats.misses;
+    stats->hit_pct = blocks ? (uint8_t)((uint64_t)fs_stats.hits * 100 / blocks) : 0;
+}
+
+extern "C" void lvgl_port_fs_start(void)
+{
+    lv_fs_drv_init(&fs_drv);
+    fs_drv.letter   = LV_PORT_FS_LETTER;
+    fs_drv.open_cb  = lvgl_fs_open;
+    fs_drv.close_cb = lvgl_fs_close;
+    fs_drv.read_cb  = lvgl_fs_read;
+    fs_drv.seek_cb  = lvgl_fs_seek;
+    fs_drv.tell_cb  = lvgl_fs_tell;
+#if LVGL_FS_DIRS
+    fs_drv.dir_open_cb  = lvgl_fs_dir_open;
+    fs_drv.dir_read_cb  = lvgl_fs_dir_read;
+    fs_drv.dir_close_cb = lvgl_fs_dir_close;
+#endif
+    lv_fs_drv_register(&fs_drv);
+}
+
+#else
+
+extern "C" const void *lvgl_port_fs_map(const char *path, size_t *size)
+{
+    (void)path;
+    *size = 0;
+    return NULL;
+}
+
+extern "C" void lvgl_port_fs_unmap(const void *data, size_t size)
+{
+    (void)data;
+    (void)size;
+}
+
+extern "C" void lvgl_port_fs_get_stats(lvgl_port_fs_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+extern "C" void lvgl_port_fs_start(void)
+{
+}
+
+#endif  // LV_PORT_FS
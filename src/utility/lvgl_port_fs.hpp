@@ -0,0 +1,73 @@
+#ifndef __LVGL_PORT_FS_HPP__
+#define __LVGL_PORT_FS_HPP__
+
+#include "lvgl.h"
+
+// 1: register a read-only lv_fs driver for the files below LV_PORT_FS_ROOT
+#ifndef LV_PORT_FS
+#define LV_PORT_FS 1
+#endif
+
+// Drive letter of the driver, e.g. lv_img_set_src(img, "M:img/logo.bin")
+#ifndef LV_PORT_FS_LETTER
+#define LV_PORT_FS_LETTER 'M'
+#endif
+
+// Prepended to every path, e.g. "/sd" or "/littlefs" on the device
+#ifndef LV_PORT_FS_ROOT
+#define LV_PORT_FS_ROOT ""
+#endif
+
+// 1: files are mmap'ed and read in place, 0: files are read through the block cache
+#ifndef LV_PORT_FS_MMAP
+#if !defined(ARDUINO) && __has_include(<sys/mman.h>)
+#define LV_PORT_FS_MMAP 1
+#else
+#define LV_PORT_FS_MMAP 0
+#endif
+#endif
+
+// Block cache: block size [bytes], blocks kept (PSRAM on boards with it), and blocks read ahead of a
+// sequential reader
+#ifndef LV_PORT_FS_BLOCK_SIZE
+#define LV_PORT_FS_BLOCK_SIZE 4096
+#endif
+#ifndef LV_PORT_FS_BLOCKS
+#define LV_PORT_FS_BLOCKS 16
+#endif
+#ifndef LV_PORT_FS_READ_AHEAD
+#define LV_PORT_FS_READ_AHEAD 2
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t opens;
+    uint32_t bytes_read;    // handed to LVGL
+    uint32_t device_bytes;  // read from the device, read-ahead included, 0 for mapped files
+    uint32_t hits;          // blocks found in the cache
+    uint32_t misses;
+    uint32_t read_ahead;    // blocks read before they were asked for
+    uint32_t seeks;         // lv_fs_seek() calls
+    uint32_t device_seeks;  // times the device had to be repositioned
+    uint8_t hit_pct;
+} lvgl_port_fs_stats_t;
+
+// Contents of the file `path` (below LV_PORT_FS_ROOT, without drive letter) for use in place, e.g. as an
+// lv_img_dsc_t's data or with lvgl_port_pack_add(). mmap'ed where LV_PORT_FS_MMAP, read into PSRAM or the heap
+// otherwise. NULL if the file cannot be read. Release with lvgl_port_fs_unmap()
+const void *lvgl_port_fs_map(const char *path, size_t *size);
+void lvgl_port_fs_unmap(const void *data, size_t size);
+
+void lvgl_port_fs_get_stats(lvgl_port_fs_stats_t *stats);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_fs_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_FS_HPP__
@@ -0,0 +1,344 @@
+#include "lvgl_port_gif.hpp"
+#include <cstdlib>  // for malloc
+#include <cstring>  // for memcmp, memcpy
+
+#if LV_PORT_GIF
+
+#if LVGL_USE_V9 == 1
+#include "lvgl_private.h"  // for lv_gif_t, gd_GIF
+#endif
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+
+#define LVGL_GIF_CACHE (LV_PORT_GIF_CACHE_SIZE > 0)
+
+#if LVGL_USE_V8 == 1
+#define LVGL_GIF_PX_SIZE LV_IMG_PX_SIZE_ALPHA_BYTE
+#else
+#define LVGL_GIF_PX_SIZE 4  // ARGB8888
+#endif
+
+typedef struct {
+    uint8_t *data;
+    lv_area_t dirty;  // changed since the frame before, image coordinates
+    uint16_t delay;   // [10 ms]
+} lvgl_gif_frame_t;
+
+typedef struct {
+    lv_obj_t *obj;  // NULL: free
+    gd_GIF *gif;    // the decoder the frames come from
+    uint32_t size;  // [bytes] per frame
+    uint32_t pos;   // decoder position after the loop's first frame, once cached
+    int32_t loops;  // left, as in gd_GIF
+    uint16_t count;  // recorded frames
+    uint16_t allocated;
+    uint16_t cur;  // frame shown once cached
+    bool cached;   // the loop repeated, frames come from the cache
+    lvgl_gif_frame_t frames[LV_PORT_GIF_FRAMES];
+} lvgl_gif_t;
+
+static uint32_t gif_frames;
+static uint32_t gif_decoded;
+static uint32_t gif_cache_used;
+static uint64_t gif_redraw_px;
+static uint64_t gif_full_px;
+#if LVGL_GIF_CACHE
+static lvgl_gif_t gifs[LV_PORT_GIFS];
+#endif
+
+static lvgl_gif_t *lvgl_gif_find(lv_obj_t *obj)
+{
+#if LVGL_GIF_CACHE
+    for (uint32_t i = 0; i < LV_PORT_GIFS; i++) {
+        if (gifs[i].obj == obj) {
+            return &gifs[i];
+        }
+    }
+#else
+    (void)obj;
+#endif
+    return NULL;
+}
+
+// Position of the decoder in the GIF data, it only goes back when the GIF loops or is restarted
+static uint32_t lvgl_gif_pos(gd_GIF *gif)
+{
+    uint32_t pos = gif->f_rw_p;
+    if (gif->is_file) {
+        lv_fs_tell(&gif->fd, &pos);
+    }
+    return pos;
+}
+
+static void lvgl_gif_seek(gd_GIF *gif, uint32_t pos)
+{
+    if (gif->is_file) {
+        lv_fs_seek(&gif->fd, pos, LV_FS_SEEK_SET);
+    } else {
+        gif->f_rw_p = pos;
+    }
+}
+
+// Shows the new frame, invalidating only `dirty` when the image is drawn 1:1 at the object's content area
+static void lvgl_gif_refresh(lv_obj_t *obj, const lv_area_t *dirty)
+{
+    lv_gif_t *gifobj = (lv_gif_t *)obj;
+    const int32_t w  = gifobj->gif->width;
+    const int32_t h  = gifobj->gif->height;
+    lv_area_t image, area;
+    lv_obj_get_content_coords(obj, &image);
+#if LVGL_USE_V8 == 1
+    lv_img_cache_invalidate_src(lv_img_get_src(obj));
+    const bool plain = lv_img_get_zoom(obj) == LV_IMG_ZOOM_NONE && lv_img_get_angle(obj) == 0 &&
+                       lv_img_get_offset_x(obj) == 0 && lv_img_get_offset_y(obj) == 0;
+#else
+    lv_image_cache_drop(lv_image_get_src(obj));
+    const bool plain = lv_image_get_scale(obj) == LV_SCALE_NONE && lv_image_get_rotation(obj) == 0 &&
+                       lv_image_get_offset_x(obj) == 0 && lv_image_get_offset_y(obj) == 0;
+#endif
+    gif_frames++;
+    gif_full_px += (uint64_t)w * h;
+
+    // Zoomed, rotated, shifted, tiled or aligned images are invalidated whole
+    if (!plain || lv_area_get_width(&image) != w || lv_area_get_height(&image) != h) {
+        gif_redraw_px += (uint64_t)w * h;
+        lv_obj_invalidate(obj);
+        return;
+    }
+    area.x1 = LV_MAX(dirty->x1, 0);
+    area.y1 = LV_MAX(dirty->y1, 0);
+    area.x2 = LV_MIN(dirty->x2, w - 1);
+    area.y2 = LV_MIN(dirty->y2, h - 1);
+    if (area.x1 > area.x2 || area.y1 > area.y2) {
+        return;  // an empty frame
+    }
+    gif_redraw_px += (uint64_t)lv_area_get_width(&area) * lv_area_get_height(&area);
+    area.x1 += image.x1;
+    area.x2 += image.x1;
+    area.y1 += image.y1;
+    area.y2 += image.y1;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+// Pauses at the end of the last repeat, returns true when the READY handler deleted the object
+static bool lvgl_gif_ready(lv_obj_t *obj, lv_timer_t *t)
+{
+    lv_timer_pause(t);
+#if LVGL_USE_V8 == 1
+    return lv_event_send(obj, LV_EVENT_READY, NULL) != LV_RES_OK;
+#else
+    return lv_obj_send_event(obj, LV_EVENT_READY, NULL) != LV_RESULT_OK;
+#endif
+}
+
+// lv_gif_set_src() called directly frees the decoder and opens a new one, which may get the same address. Once
+// cached, the new source shows its own canvas instead of the cached frame
+static bool lvgl_gif_replaced(const lvgl_gif_t *g)
+{
+    const lv_gif_t *gifobj = (const lv_gif_t *)g->obj;
+    if (gifobj->gif != g->gif) {
+        return true;
+    }
+    if (g->cached) {
+        return gifobj->imgdsc.data != g->frames[g->cur].data;
+    }
+    return (uint32_t)gifobj->gif->width * gifobj->gif->height * LVGL_GIF_PX_SIZE != g->size;
+}
+
+static void lvgl_gif_release(lvgl_gif_t *g)
+{
+    lv_gif_t *gifobj = (lv_gif_t *)g->obj;
+    if (g->cached && gifobj->imgdsc.data == g->frames[g->cur].data) {
+        gifobj->imgdsc.data = g->gif->canvas;
+    }
+    for (uint32_t i = 0; i < g->allocated; i++) {
+        free(g->frames[i].data);
+    }
+    gif_cache_used -= g->allocated * g->size;
+    memset(g, 0, sizeof(*g));
+}
+
+// Appends the frame just decoded to the recorded loop. When the GIF wraps around to a first frame equal to the
+// recorded one, the loop repeats and is shown from the cache from then on
+static void lvgl_gif_record(lvgl_gif_t *g, const lv_area_t *dirty, bool wrapped)
+{
+    lv_gif_t *gifobj      = (lv_gif_t *)g->obj;
+    gd_GIF *gif           = gifobj->gif;
+    const uint8_t *canvas = (const uint8_t *)gifobj->imgdsc.data;
+    if (wrapped) {
+        if (g->count && memcmp(g->frames[0].data, canvas, g->size) == 0) {
+            g->frames[0].dirty  = *dirty;
+            g->frames[0].delay  = gif->gce.delay;
+            g->cur              = 0;
+            g->loops            = gif->loop_count;
+            g->pos              = lvgl_gif_pos(gif);
+            g->cached           = true;
+            gifobj->imgdsc.data = g->frames[0].data;
+            return;
+        }
+        g->count = 0;  // the first loop started from a different canvas, record the next one
+    }
+    if (g->count == g->allocated) {
+        uint8_t *data = NULL;
+        if (g->count < LV_PORT_GIF_FRAMES && gif_cache_used + g->size <= LV_PORT_GIF_CACHE_SIZE) {
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && defined(BOARD_HAS_PSRAM)
+            data = (uint8_t *)heap_caps_malloc(g->size, MALLOC_CAP_SPIRAM);
+#else
+            data = (uint8_t *)malloc(g->size);
+#endif
+        }
+        if (data == NULL) {
+            lvgl_gif_release(g);  // the loop is too long, decode every frame
+            return;
+        }
+        g->frames[g->allocated++].data = data;
+        gif_cache_used += g->size;
+    }
+    lvgl_gif_frame_t *frame = &g->frames[g->count++];
+    memcpy(frame->data, canvas, g->size);
+    frame->dirty = *dirty;
+    frame->delay = gif->gce.delay;
+}
+
+static void lvgl_gif_next_cached(lvgl_gif_t *g, lv_timer_t *t)
+{
+    lv_gif_t *gifobj = (lv_gif_t *)g->obj;
+    lv_area_t dirty;
+    if (lvgl_gif_pos(g->gif) != g->pos) {
+        // lv_gif_restart() rewound the decoder, put it back where the cache expects it
+        lvgl_gif_seek(g->gif, g->pos);
+        g->cur = 0;
+        lv_area_set(&dirty, 0, 0, g->gif->width - 1, g->gif->height - 1);
+    } else if (++g->cur == g->count) {
+        // Loop counting as gd_get_frame() does it
+        if (g->loops == 1 || g->loops < 0) {
+            g->cur--;
+            lvgl_gif_ready(g->obj, t);
+            return;
+        }
+        if (g->loops > 1) {
+            g->loops--;
+        }
+        g->cur = 0;
+        dirty  = g->frames[0].dirty;
+    } else {
+        dirty = g->frames[g->cur].dirty;
+    }
+    gifobj->imgdsc.data = g->frames[g->cur].data;
+    lvgl_gif_refresh(g->obj, &dirty);
+}
+
+// Replaces lv_gif's timer callback
+static void lvgl_gif_next_frame(lv_timer_t *t)
+{
+#if LVGL_USE_V8 == 1
+    lv_obj_t *obj = (lv_obj_t *)t->user_data;
+#else
+    lv_obj_t *obj = (lv_obj_t *)lv_timer_get_user_data(t);
+#endif
+    lv_gif_t *gifobj = (lv_gif_t *)obj;
+    gd_GIF *gif      = gifobj->gif;
+    if (gif == NULL) {
+        return;
+    }
+    lvgl_gif_t *g = lvgl_gif_find(obj);
+    if (g && lvgl_gif_replaced(g)) {
+        lvgl_gif_release(g);
+        g = NULL;
+    }
+
+    const uint32_t delay = g && g->cached ? g->frames[g->cur].delay : gif->gce.delay;
+    if (lv_tick_elaps(gifobj->last_call) < delay * 10) {
+        return;
+    }
+    gifobj->last_call = lv_tick_get();
+    if (g && g->cached) {
+        lvgl_gif_next_cached(g, t);
+        return;
+    }
+
+    // gd_get_frame() first disposes of the previous frame: areas restored to the background (2) or to the
+    // previous canvas (3) change too
+    lv_area_t dirty;
+    lv_area_set(&dirty, gif->fx, gif->fy, gif->fx + gif->fw - 1, gif->fy + gif->fh - 1);
+    const bool disposed = gif->gce.disposal >= 2;
+    const uint32_t pos  = lvgl_gif_pos(gif);
+    const int has_next  = gd_get_frame(gif);
+    if (has_next == 0 && lvgl_gif_ready(obj, t)) {
+        return;
+    }
+    gd_render_frame(gif, (uint8_t *)gifobj->imgdsc.data);
+    gif_decoded++;
+
+    if (disposed) {
+        dirty.x1 = LV_MIN(dirty.x1, gif->fx);
+        dirty.y1 = LV_MIN(dirty.y1, gif->fy);
+        dirty.x2 = LV_MAX(dirty.x2, gif->fx + gif->fw - 1);
+        dirty.y2 = LV_MAX(dirty.y2, gif->fy + gif->fh - 1);
+    } else {
+        lv_area_set(&dirty, gif->fx, gif->fy, gif->fx + gif->fw - 1, gif->fy + gif->fh - 1);
+    }
+    if (g && has_next == 1) {
+        lvgl_gif_record(g, &dirty, lvgl_gif_pos(gif) < pos);
+    }
+    lvgl_gif_refresh(obj, &dirty);
+}
+
+static void lvgl_gif_deleted(lv_event_t *e)
+{
+    lvgl_gif_t *g = lvgl_gif_find((lv_obj_t *)lv_event_get_target(e));
+    if (g) {
+        lvgl_gif_release(g);
+    }
+}
+
+extern "C" void lvgl_port_gif_set_src(lv_obj_t *obj, const void *src)
+{
+    lv_gif_t *gifobj = (lv_gif_t *)obj;
+    lvgl_gif_t *g    = lvgl_gif_find(obj);
+    if (g) {
+        lvgl_gif_release(g);
+    }
+    lv_gif_set_src(obj, src);  // decodes and shows the first frame
+    lv_timer_set_cb(gifobj->timer, lvgl_gif_next_frame);
+    if (gifobj->gif == NULL || (g = lvgl_gif_find(NULL)) == NULL) {
+        return;  // no source, no frame cache, or LV_PORT_GIFS GIFs are cached already
+    }
+
+    g->obj  = obj;
+    g->gif  = gifobj->gif;
+    g->size = (uint32_t)gifobj->gif->width * gifobj->gif->height * LVGL_GIF_PX_SIZE;
+    lv_obj_remove_event_cb(obj, lvgl_gif_deleted);
+    lv_obj_add_event_cb(obj, lvgl_gif_deleted, LV_EVENT_DELETE, NULL);
+    lv_area_t full;
+    lv_area_set(&full, 0, 0, gifobj->gif->width - 1, gifobj->gif->height - 1);
+    lvgl_gif_record(g, &full, false);
+}
+
+extern "C" void lvgl_port_gif_get_stats(lvgl_port_gif_stats_t *stats)
+{
+    stats->frames     = gif_frames;
+    stats->decoded    = gif_decoded;
+    stats->cache_used = gif_cache_used;
+    stats->redraw_pct = gif_full_px ? (uint8_t)(gif_redraw_px * 100 / gif_full_px) : 0;
+}
+
+#else
+
+extern "C" void lvgl_port_gif_set_src(lv_obj_t *gif, const void *src)
+{
+#if defined(LV_USE_GIF) && LV_USE_GIF
+    lv_gif_set_src(gif, src);
+#else
+    (void)gif;
+    (void)src;
+#endif
+}
+
+extern "C" void lvgl_port_gif_get_stats(lvgl_port_gif_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif  // LV_PORT_GIF
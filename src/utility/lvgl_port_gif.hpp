@@ -0,0 +1,58 @@
+#ifndef __LVGL_PORT_GIF_HPP__
+#define __LVGL_PORT_GIF_HPP__
+
+#include "lvgl.h"
+
+// 1: play lv_gif objects set up with lvgl_port_gif_set_src() frame by frame, redrawing only what changed
+#ifndef LV_PORT_GIF
+#if defined(LV_USE_GIF) && LV_USE_GIF
+#define LV_PORT_GIF 1
+#else
+#define LV_PORT_GIF 0
+#endif
+#endif
+
+// Bytes of fully decoded frames kept for looping GIFs (PSRAM on boards with it), per board profile
+// (LV_PORT_CACHE_PROFILE in lv_conf.h). 0: every frame is decoded each time
+#ifndef LV_PORT_GIF_CACHE_SIZE
+#if LV_PORT_CACHE_PROFILE >= 3
+#define LV_PORT_GIF_CACHE_SIZE (8 * 1024 * 1024)
+#elif LV_PORT_CACHE_PROFILE == 2
+#define LV_PORT_GIF_CACHE_SIZE (1024 * 1024)
+#else
+#define LV_PORT_GIF_CACHE_SIZE 0
+#endif
+#endif
+
+// GIFs whose frames can be cached at the same time, and frames of a loop that are cached at most
+#ifndef LV_PORT_GIFS
+#define LV_PORT_GIFS 4
+#endif
+#ifndef LV_PORT_GIF_FRAMES
+#define LV_PORT_GIF_FRAMES 32
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t frames;      // shown since start
+    uint32_t decoded;     // of them decoded, the others came from the frame cache
+    uint32_t cache_used;  // [bytes]
+    uint8_t redraw_pct;   // redrawn share of the GIFs' areas, 100 when every frame invalidates the whole image
+} lvgl_port_gif_stats_t;
+
+// Use instead of lv_gif_set_src() on an lv_gif object. From the next frame on, only the area the frame and the
+// disposal of the previous frame touch is invalidated. A loop of at most LV_PORT_GIF_FRAMES frames that fits in
+// the frame cache is recorded while it plays, and shown from the cache without decoding once it repeats.
+// Call with the GUI lock held
+void lvgl_port_gif_set_src(lv_obj_t *gif, const void *src);
+
+void lvgl_port_gif_get_stats(lvgl_port_gif_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_GIF_HPP__
@@ -0,0 +1,364 @@
+#include "lvgl_port_glyph.hpp"
+#include "lvgl_port_cache.hpp"
+#include <cstring>  // for memcpy
+
+#if LV_PORT_GLYPH_CACHE
+
+#if LVGL_USE_V9 == 1 && LV_USE_OS != LV_OS_NONE
+#include <mutex>
+#define LVGL_GLYPH_LOCKED 1  // the draw threads decode glyphs
+#else
+#define LVGL_GLYPH_LOCKED 0
+#endif
+
+#define LVGL_GLYPH_BUCKETS   256  // power of two
+#define LVGL_GLYPH_MAX_SHARE 8    // a glyph larger than this share of the cache is decoded every time
+
+// Decoded A8 bitmap of one glyph, the pixels follow the header row by row without padding
+typedef struct lvgl_glyph_t {
+    struct lvgl_glyph_t *hash_next;
+    struct lvgl_glyph_t *prev;  // LRU list, most recently used first
+    struct lvgl_glyph_t *next;
+    uint32_t key;   // v8: code point, v9: glyph index
+    uint16_t font;  // in glyph_fonts
+    uint16_t w, h;
+    uint32_t bytes;  // header included
+} lvgl_glyph_t;
+
+static lv_font_t glyph_fonts[LV_PORT_GLYPH_FONTS];  // the wrappers lvgl_port_glyph_font() hands out
+static const lv_font_t *glyph_orig[LV_PORT_GLYPH_FONTS];
+static uint32_t glyph_font_cnt;
+static lvgl_glyph_t *glyph_buckets[LVGL_GLYPH_BUCKETS];
+static lvgl_glyph_t *glyph_head;
+static lvgl_glyph_t *glyph_tail;
+static uint32_t glyph_budget;  // [bytes], set by lvgl_port_glyph_set_budget()
+static uint32_t glyph_used;
+static uint32_t glyph_cnt;
+static uint32_t glyph_lookups;
+static uint32_t glyph_hits;
+static uint32_t glyph_evictions;
+#if LVGL_GLYPH_LOCKED
+static std::mutex glyph_mutex;
+#define LVGL_GLYPH_LOCK() std::lock_guard<std::mutex> lvgl_glyph_guard(glyph_mutex)
+#else
+#define LVGL_GLYPH_LOCK()
+#endif
+
+static inline uint8_t *lvgl_glyph_data(lvgl_glyph_t *g)
+{
+    return (uint8_t *)(g + 1);
+}
+
+static inline lvgl_glyph_t **lvgl_glyph_bucket(uint16_t font, uint32_t key)
+{
+    return &glyph_buckets[((key * 2654435761U) ^ font) & (LVGL_GLYPH_BUCKETS - 1)];
+}
+
+static inline uint16_t lvgl_glyph_font_id(const lv_font_t *font)
+{
+    return (uint16_t)(font - glyph_fonts);
+}
+
+static void lvgl_glyph_unlink(lvgl_glyph_t *g)
+{
+    (g->prev ? g->prev->next : glyph_head) = g->next;
+    (g->next ? g->next->prev : glyph_tail) = g->prev;
+}
+
+static void lvgl_glyph_push_front(lvgl_glyph_t *g)
+{
+    g->prev = NULL;
+    g->next = glyph_head;
+    (glyph_head ? glyph_head->prev : glyph_tail) = g;
+    glyph_head = g;
+}
+
+static void lvgl_glyph_free(lvgl_glyph_t *g)
+{
+    lvgl_glyph_t **p = lvgl_glyph_bucket(g->font, g->key);
+    while (*p != g) {
+        p = &(*p)->hash_next;
+    }
+    *p = g->hash_next;
+    lvgl_glyph_unlink(g);
+    glyph_used -= g->bytes;
+    glyph_cnt--;
+#if LVGL_USE_V8 == 1
+    lv_mem_free(g);
+#else
+    lv_free(g);
+#endif
+}
+
+static lvgl_glyph_t *lvgl_glyph_find(uint16_t font, uint32_t key)
+{
+    for (lvgl_glyph_t *g = *lvgl_glyph_bucket(font, key); g; g = g->hash_next) {
+        if (g->key == key && g->font == font) {
+            if (g != glyph_head) {
+                lvgl_glyph_unlink(g);
+                lvgl_glyph_push_front(g);
+            }
+            return g;
+        }
+    }
+    return NULL;
+}
+
+// Makes room by evicting the least recently used glyphs, NULL if the glyph is too large or memory is out
+static lvgl_glyph_t *lvgl_glyph_insert(uint16_t font, uint32_t key, uint16_t w, uint16_t h)
+{
+    const uint32_t bytes = (uint32_t)sizeof(lvgl_glyph_t) + (uint32_t)w * h;
+    if (bytes > glyph_budget / LVGL_GLYPH_MAX_SHARE) {
+        return NULL;
+    }
+    while (glyph_tail && glyph_used + bytes > glyph_budget) {
+        lvgl_glyph_free(glyph_tail);
+        glyph_evictions++;
+    }
+#if LVGL_USE_V8 == 1
+    lvgl_glyph_t *g = (lvgl_glyph_t *)lv_mem_alloc(bytes);
+#else
+    lvgl_glyph_t *g = (lvgl_glyph_t *)lv_malloc(bytes);
+#endif
+    if (g == NULL) {
+        return NULL;
+    }
+    g->key   = key;
+    g->font  = font;
+    g->w     = w;
+    g->h     = h;
+    g->bytes = bytes;
+    lvgl_glyph_t **bucket = lvgl_glyph_bucket(font, key);
+    g->hash_next          = *bucket;
+    *bucket               = g;
+    lvgl_glyph_push_front(g);
+    glyph_used += bytes;
+    glyph_cnt++;
+    return g;
+}
+
+#if LVGL_USE_V8 == 1
+static uint8_t *glyph_scratch;  // A8 of a glyph the cache cannot hold, valid until the next one
+static uint32_t glyph_scratch_size;
+
+// Same opacities as LVGL's bpp tables in lv_draw_sw_letter.c
+static void lvgl_glyph_expand(uint8_t *dst, const uint8_t *src, uint32_t px, uint8_t bpp)
+{
+    if (bpp == 8) {
+        memcpy(dst, src, px);
+        return;
+    }
+    const uint8_t max      = (uint8_t)((1 << bpp) - 1);
+    const uint8_t per_byte = (uint8_t)(8 / bpp);
+    for (uint32_t i = 0; i < px; i++) {
+        const uint8_t v = (src[i / per_byte] >> (8 - bpp - (i % per_byte) * bpp)) & max;
+        dst[i]          = (uint8_t)(v * 255 / max);
+    }
+}
+
+// The wrapper's glyphs are A8, LVGL's draw loop then reads a byte per pixel instead of unpacking bits
+static bool lvgl_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t letter,
+                           uint32_t letter_next)
+{
+    if (!lv_font_get_glyph_dsc_fmt_txt(font, dsc_out, letter, letter_next)) {
+        return false;
+    }
+    dsc_out->bpp = 8;
+    return true;
+}
+
+static const uint8_t *lvgl_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    const uint16_t id = lvgl_glyph_font_id(font);
+    glyph_lookups++;
+    lvgl_glyph_t *g = lvgl_glyph_find(id, letter);
+    if (g) {
+        glyph_hits++;
+        return lvgl_glyph_data(g);
+    }
+
+    // Compressed fonts are decompressed into LVGL's buffer here, plain ones come straight from flash
+    lv_font_glyph_dsc_t dsc;
+    if (!lv_font_get_glyph_dsc_fmt_txt(font, &dsc, letter, 0)) {
+        return NULL;
+    }
+    const uint8_t *src = lv_font_get_bitmap_fmt_txt(font, letter);
+    if (src == NULL) {
+        return NULL;
+    }
+    const uint32_t px = (uint32_t)dsc.box_w * dsc.box_h;
+    uint8_t *dst;
+    g = lvgl_glyph_insert(id, letter, dsc.box_w, dsc.box_h);
+    if (g) {
+        dst = lvgl_glyph_data(g);
+    } else {
+        if (px > glyph_scratch_size) {
+            uint8_t *buf = (uint8_t *)lv_mem_realloc(glyph_scratch, px);
+            if (buf == NULL) {
+                return NULL;
+            }
+            glyph_scratch      = buf;
+            glyph_scratch_size = px;
+        }
+        dst = glyph_scratch;
+    }
+    lvgl_glyph_expand(dst, src, px, dsc.bpp == 3 ? 4 : dsc.bpp);  // LVGL draws 3 bpp as 4 bpp
+    return dst;
+}
+#else
+static void lvgl_glyph_copy(uint8_t *dst, uint32_t dst_stride, const uint8_t *src, uint32_t src_stride,
+                            uint16_t w, uint16_t h)
+{
+    for (uint16_t y = 0; y < h; y++) {
+        memcpy(dst + y * dst_stride, src + y * src_stride, w);
+    }
+}
+
+// LVGL decodes into the label's A8 draw buffer, a cached glyph is copied in instead
+static const void *lvgl_glyph_bitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf)
+{
+    if (dsc->req_raw_bitmap || draw_buf == NULL || dsc->format < LV_FONT_GLYPH_FORMAT_A1 ||
+        dsc->format > LV_FONT_GLYPH_FORMAT_A8) {
+        return lv_font_get_bitmap_fmt_txt(dsc, draw_buf);
+    }
+    const uint16_t id     = lvgl_glyph_font_id(dsc->resolved_font);
+    const uint32_t key    = dsc->gid.index;
+    const uint32_t stride = draw_buf->header.stride;
+    {
+        LVGL_GLYPH_LOCK();
+        glyph_lookups++;
+        lvgl_glyph_t *g = lvgl_glyph_find(id, key);
+        if (g) {
+            glyph_hits++;
+            lvgl_glyph_copy((uint8_t *)draw_buf->data, stride, lvgl_glyph_data(g), g->w, g->w, g->h);
+            return draw_buf;
+        }
+    }
+
+    // Decoded without the lock, so the draw threads do not wait on each other's misses
+    const void *res = lv_font_get_bitmap_fmt_txt(dsc, draw_buf);
+    if (res) {
+        LVGL_GLYPH_LOCK();
+        if (lvgl_glyph_find(id, key) == NULL) {
+            lvgl_glyph_t *g = lvgl_glyph_insert(id, key, dsc->box_w, dsc->box_h);
+            if (g) {
+                lvgl_glyph_copy(lvgl_glyph_data(g), g->w, (const uint8_t *)draw_buf->data, stride, g->w, g->h);
+            }
+        }
+    }
+    return res;
+}
+#endif
+
+extern "C" const lv_font_t *lvgl_port_glyph_font(const lv_font_t *font)
+{
+    if (font == NULL || font->get_glyph_bitmap == lvgl_glyph_bitmap) {
+        return font;
+    }
+    for (uint32_t i = 0; i < glyph_font_cnt; i++) {
+        if (glyph_orig[i] == font) {
+            return &glyph_fonts[i];
+        }
+    }
+    if (font->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt || glyph_font_cnt == LV_PORT_GLYPH_FONTS) {
+        return font;
+    }
+#if LVGL_USE_V8 == 1
+    if (font->subpx != LV_FONT_SUBPX_NONE) {
+        return font;
+    }
+#endif
+
+    // A writable copy: built-in fonts are const and may live in flash
+    lv_font_t *wrapped = &glyph_fonts[glyph_font_cnt];
+    *wrapped           = *font;
+#if LVGL_USE_V8 == 1
+    wrapped->get_glyph_dsc = lvgl_glyph_dsc;
+#endif
+    wrapped->get_glyph_bitmap  = lvgl_glyph_bitmap;
+    glyph_orig[glyph_font_cnt++] = font;
+    return wrapped;
+}
+
+extern "C" void lvgl_port_glyph_get_stats(lvgl_port_glyph_stats_t *stats)
+{
+    LVGL_GLYPH_LOCK();
+    stats->size      = glyph_budget;
+    stats->used      = glyph_used;
+    stats->glyphs    = glyph_cnt;
+    stats->fonts     = glyph_font_cnt;
+    stats->lookups   = glyph_lookups;
+    stats->hits      = glyph_hits;
+    stats->evictions = glyph_evictions;
+    stats->hit_pct   = glyph_lookups ? (uint8_t)((uint64_t)glyph_hits * 100 / glyph_lookups) : 0;
+}
+
+extern "C" void lvgl_port_glyph_clear(void)
+{
+    LVGL_GLYPH_LOCK();
+    while (glyph_tail) {
+        lvgl_glyph_free(glyph_tail);
+    }
+}
+
+extern "C" void lvgl_port_glyph_set_budget(uint32_t bytes)
+{
+    LVGL_GLYPH_LOCK();
+    glyph_budget = LV_MIN(bytes, (uint32_t)LV_PORT_GLYPH_CACHE_SIZE);
+    while (glyph_tail && glyph_used > glyph_budget) {
+        lvgl_glyph_free(glyph_tail);
+        glyph_evictions++;
+    }
+}
+
+extern "C" void lvgl_port_glyph_start(void)
+{
+#if !LV_PORT_CACHE
+    // No cache manager to share LVGL's heap with
+    uint32_t capacity, free_pct;
+    lvgl_port_cache_heap(&capacity, &free_pct);
+    lvgl_port_glyph_set_budget((uint32_t)((uint64_t)capacity * LV_PORT_CACHE_HEAP_PCT / 100 / 4));
+#endif
+#if LV_USE_THEME_DEFAULT
+    // Objects created from now on get the default theme's font through the cache
+    lv_theme_t *theme = lv_theme_get_from_obj(NULL);
+    if (theme == NULL || theme != lv_theme_default_get()) {
+        return;
+    }
+    const lv_font_t *font = lvgl_port_glyph_font(lv_theme_get_font_normal(NULL));
+#if LVGL_USE_V8 == 1
+    lv_theme_default_init(lv_disp_get_default(), lv_theme_get_color_primary(NULL),
+                          lv_theme_get_color_secondary(NULL), LV_THEME_DEFAULT_DARK, font);
+#else
+    lv_theme_default_init(lv_display_get_default(), lv_theme_get_color_primary(NULL),
+                          lv_theme_get_color_secondary(NULL), LV_THEME_DEFAULT_DARK, font);
+#endif
+#endif
+}
+
+#else
+
+extern "C" const lv_font_t *lvgl_port_glyph_font(const lv_font_t *font)
+{
+    return font;
+}
+
+extern "C" void lvgl_port_glyph_get_stats(lvgl_port_glyph_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+extern "C" void lvgl_port_glyph_clear(void)
+{
+}
+
+extern "C" void lvgl_port_glyph_start(void)
+{
+}
+
+extern "C" void lvgl_port_glyph_set_budget(uint32_t bytes)
+{
+    (void)bytes;
+}
+
+#endif  // LV_PORT_GLYPH_CACHE
@@ -0,0 +1,64 @@
+#ifndef __LVGL_PORT_GLYPH_HPP__
+#define __LVGL_PORT_GLYPH_HPP__
+
+#include "lvgl.h"
+
+// Most bytes of decoded glyph bitmaps kept, per board profile (LV_PORT_CACHE_PROFILE in lv_conf.h). The glyphs live
+// in LVGL's heap: the cache manager (lvgl_port_cache.hpp) budgets them together with the image caches, without it
+// they get at most a quarter of LV_PORT_CACHE_HEAP_PCT of the heap
+#ifndef LV_PORT_GLYPH_CACHE_SIZE
+#if LV_PORT_CACHE_PROFILE >= 2
+#define LV_PORT_GLYPH_CACHE_SIZE (64 * 1024)
+#elif LV_PORT_CACHE_PROFILE == 1
+#define LV_PORT_GLYPH_CACHE_SIZE (8 * 1024)
+#else
+#define LV_PORT_GLYPH_CACHE_SIZE 0
+#endif
+#endif
+
+// 1: cache the decoded glyphs of the default theme's font and of the fonts passed through lvgl_port_glyph_font()
+#ifndef LV_PORT_GLYPH_CACHE
+#define LV_PORT_GLYPH_CACHE (LV_PORT_GLYPH_CACHE_SIZE > 0)
+#endif
+
+// Fonts lvgl_port_glyph_font() can wrap
+#ifndef LV_PORT_GLYPH_FONTS
+#define LV_PORT_GLYPH_FONTS 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t size;       // current budget [bytes], at most LV_PORT_GLYPH_CACHE_SIZE
+    uint32_t used;       // [bytes], bookkeeping included
+    uint32_t glyphs;     // cached glyphs
+    uint32_t fonts;      // wrapped fonts
+    uint32_t lookups;    // since start
+    uint32_t hits;
+    uint32_t evictions;
+    uint8_t hit_pct;
+} lvgl_port_glyph_stats_t;
+
+// Returns a font that draws like `font` but takes its glyph bitmaps from the cache, the same one for every call
+// with the same font. Use it in styles instead of `font`. Fonts that are not in LVGL's built-in format (or
+// subpixel fonts in v8), and fonts beyond LV_PORT_GLYPH_FONTS, come back unchanged. Call with the GUI lock held
+const lv_font_t *lvgl_port_glyph_font(const lv_font_t *font);
+
+// Call with the GUI lock held
+void lvgl_port_glyph_get_stats(lvgl_port_glyph_stats_t *stats);
+
+// Drops every cached glyph. Call with the GUI lock held
+void lvgl_port_glyph_clear(void);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_glyph_start(void);
+// Evicts down to `bytes` and keeps the cache within them, capped at LV_PORT_GLYPH_CACHE_SIZE
+void lvgl_port_glyph_set_budget(uint32_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_GLYPH_HPP__
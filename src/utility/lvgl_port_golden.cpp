@@ -0,0 +1,223 @@
+#include "lvgl_port_golden.hpp"
+#include "lvgl_port_screenshot.hpp"
+#include <cstdio>  // for snprintf
+
+#define LVGL_GOLDEN_PATH_MAX 256
+
+typedef struct {
+    const char *name;
+    void (*create)(lv_obj_t *parent);
+} lvgl_golden_scene_t;
+
+static lvgl_port_golden_config_t golden_config = {NULL};
+static bool golden_requested;
+
+static lv_color_t lvgl_golden_color(uint32_t i)
+{
+    static const lv_palette_t palette[] = {LV_PALETTE_RED,   LV_PALETTE_BLUE,  LV_PALETTE_GREEN, LV_PALETTE_ORANGE,
+                                           LV_PALETTE_PURPLE, LV_PALETTE_TEAL, LV_PALETTE_PINK,  LV_PALETTE_INDIGO};
+    return lv_palette_main(palette[i % (sizeof(palette) / sizeof(palette[0]))]);
+}
+
+static lv_obj_t *lvgl_golden_rect(lv_obj_t *parent, uint32_t i)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(obj, lvgl_golden_color(i), 0);
+    return obj;
+}
+
+// Filled, rounded, bordered, shadowed, gradient and half transparent boxes across a dark band
+static void lvgl_golden_shapes(lv_obj_t *parent)
+{
+    const int32_t w = lv_obj_get_width(parent);
+    const int32_t h = lv_obj_get_height(parent);
+    lv_obj_t *band  = lvgl_golden_rect(parent, 0);
+    lv_obj_set_style_bg_color(band, lv_color_black(), 0);
+    lv_obj_set_size(band, w, h / 4);
+    lv_obj_set_pos(band, 0, h * 3 / 8);
+
+    for (uint32_t i = 0; i < 6; i++) {
+        lv_obj_t *obj = lvgl_golden_rect(parent, i);
+        lv_obj_set_size(obj, w / 3 - 16, h / 2 - 16);
+        lv_obj_set_pos(obj, (int32_t)(i % 3) * w / 3 + 8, (int32_t)(i / 3) * h / 2 + 8);
+        if (i >= 1) {
+            lv_obj_set_style_radius(obj, 12, 0);
+        }
+        if (i == 2) {
+            lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, 0);
+            lv_obj_set_style_border_width(obj, 5, 0);
+            lv_obj_set_style_border_color(obj, lvgl_golden_color(i), 0);
+        } else if (i == 3) {
+            lv_obj_set_style_shadow_width(obj, 20, 0);
+            lv_obj_set_style_shadow_color(obj, lvgl_golden_color(i + 1), 0);
+        } else if (i == 4) {
+            lv_obj_set_style_bg_grad_color(obj, lvgl_golden_color(i + 3), 0);
+            lv_obj_set_style_bg_grad_dir(obj, LV_GRAD_DIR_VER, 0);
+        } else if (i == 5) {
+            lv_obj_set_style_bg_opa(obj, LV_OPA_50, 0);
+        }
+    }
+}
+
+static lv_obj_t *lvgl_golden_label(lv_obj_t *parent, const char *text, const lv_font_t *font, uint32_t color)
+{
+    lv_obj_t *obj = lv_label_create(parent);
+    lv_label_set_text(obj, text);
+    lv_obj_set_style_text_font(obj, font, 0);
+    lv_obj_set_style_text_color(obj, lvgl_golden_color(color), 0);
+    return obj;
+}
+
+// Text in the enabled Montserrat sizes, wrapped, centered and underlined
+static void lvgl_golden_text(lv_obj_t *parent)
+{
+    lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_all(parent, 6, 0);
+    lv_obj_set_style_pad_row(parent, 4, 0);
+    lvgl_golden_label(parent, "Montserrat 14: 0123456789", &lv_font_montserrat_14, 1);
+#if LV_FONT_MONTSERRAT_20
+    lvgl_golden_label(parent, "Montserrat 20: AaBbCc", &lv_font_montserrat_20, 2);
+#endif
+#if LV_FONT_MONTSERRAT_26
+    lvgl_golden_label(parent, "Montserrat 26", &lv_font_montserrat_26, 3);
+#endif
+    lv_obj_t *obj = lvgl_golden_label(parent,
+                                      "The quick brown fox jumps over the lazy dog. "
+                                      "Pack my box with five dozen liquor jugs.",
+                                      &lv_font_montserrat_14, 7);
+    lv_obj_set_width(obj, lv_pct(100));
+    lv_obj_set_style_text_align(obj, LV_TEXT_ALIGN_CENTER, 0);
+    obj = lvgl_golden_label(parent, "Underlined, letter spaced", &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_decor(obj, LV_TEXT_DECOR_UNDERLINE, 0);
+    lv_obj_set_style_text_letter_space(obj, 2, 0);
+}
+
+// Default theme widgets, values set without animations
+static void lvgl_golden_widgets(lv_obj_t *parent)
+{
+    lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_style_pad_all(parent, 6, 0);
+    lv_obj_set_style_pad_gap(parent, 8, 0);
+
+#if LVGL_USE_V8 == 1
+    lv_obj_t *obj = lv_btn_create(parent);
+#else
+    lv_obj_t *obj = lv_button_create(parent);
+#endif
+    lv_label_set_text(lv_label_create(obj), "Button");
+    obj = lv_checkbox_create(parent);
+    lv_checkbox_set_text(obj, "Check");
+    lv_switch_create(parent);
+    obj = lv_slider_create(parent);
+    lv_obj_set_width(obj, lv_pct(40));
+    lv_slider_set_value(obj, 40, LV_ANIM_OFF);
+    obj = lv_bar_create(parent);
+    lv_obj_set_width(obj, lv_pct(40));
+    lv_bar_set_value(obj, 70, LV_ANIM_OFF);
+    obj = lv_arc_create(parent);
+    lv_obj_set_size(obj, 80, 80);
+    lv_arc_set_value(obj, 60);
+    obj = lv_dropdown_create(parent);
+    lv_dropdown_set_options(obj, "One\nTwo\nThree");
+}
+
+// Line chart with fixed points
+static void lvgl_golden_chart(lv_obj_t *parent)
+{
+    static const int32_t points[] = {10, 35, 20, 60, 45, 80, 70, 30, 55, 90};
+    lv_obj_t *chart = lv_chart_create(parent);
+    lv_obj_set_size(chart, lv_pct(90), lv_pct(80));
+    lv_obj_center(chart);
+    lv_chart_set_point_count(chart, sizeof(points) / sizeof(points[0]));
+    lv_chart_series_t *ser = lv_chart_add_series(chart, lvgl_golden_color(0), LV_CHART_AXIS_PRIMARY_Y);
+    for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+        lv_chart_set_next_value(chart, ser, points[i]);
+    }
+}
+
+// Overlapping translucent panels over a gradient, one of them rendered through a layer (opa style)
+static void lvgl_golden_layers(lv_obj_t *parent)
+{
+    const int32_t w = lv_obj_get_width(parent);
+    const int32_t h = lv_obj_get_height(parent);
+    lv_obj_t *bg    = lvgl_golden_rect(parent, 1);
+    lv_obj_set_size(bg, w, h);
+    lv_obj_set_style_bg_grad_color(bg, lvgl_golden_color(4), 0);
+    lv_obj_set_style_bg_grad_dir(bg, LV_GRAD_DIR_HOR, 0);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        lv_obj_t *obj = lvgl_golden_rect(parent, i + 2);
+        lv_obj_set_size(obj, w / 2, h / 2);
+        lv_obj_set_pos(obj, (int32_t)i * w / 5 + 4, (int32_t)i * h / 5 + 4);
+        lv_obj_set_style_radius(obj, 10, 0);
+        lv_obj_set_style_bg_opa(obj, LV_OPA_70, 0);
+        lv_obj_set_style_shadow_width(obj, 12, 0);
+    }
+
+    lv_obj_t *layer = lvgl_golden_rect(parent, 6);
+    lv_obj_set_size(layer, w / 2, h / 3);
+    lv_obj_align(layer, LV_ALIGN_BOTTOM_RIGHT, -4, -4);
+    lv_obj_set_style_opa(layer, LV_OPA_60, 0);
+    lv_obj_t *label = lv_label_create(layer);
+    lv_label_set_text(label, "Layer");
+    lv_obj_center(label);
+}
+
+static const lvgl_golden_scene_t golden_scenes[] = {
+    {"shapes", lvgl_golden_shapes}, {"text", lvgl_golden_text},     {"widgets", lvgl_golden_widgets},
+    {"chart", lvgl_golden_chart},   {"layers", lvgl_golden_layers},
+};
+
+extern "C" void lvgl_port_golden_request(const lvgl_port_golden_config_t *config)
+{
+    golden_config    = *config;
+    golden_requested = true;
+}
+
+extern "C" bool lvgl_port_golden_requested(void)
+{
+    return golden_requested;
+}
+
+extern "C" bool lvgl_port_golden_run(void)
+{
+    const char *dir = golden_config.output ? golden_config.output : ".";
+#if LVGL_USE_V8 == 1
+    lv_obj_t *screen = lv_scr_act();
+#else
+    lv_obj_t *screen = lv_screen_active();
+#endif
+
+    bool ok = true;
+    for (size_t s = 0; s < sizeof(golden_scenes) / sizeof(golden_scenes[0]); s++) {
+        // A fresh parent per scene, so no layout or padding carries over
+        lv_obj_t *parent = lv_obj_create(screen);
+        lv_obj_remove_style_all(parent);
+        lv_obj_set_size(parent, lv_obj_get_width(screen), lv_obj_get_height(screen));
+        lv_obj_set_style_bg_opa(parent, LV_OPA_COVER, 0);
+        lv_obj_set_style_bg_color(parent, lv_color_white(), 0);
+        lv_obj_update_layout(parent);
+        golden_scenes[s].create(parent);
+        lv_obj_update_layout(parent);
+        lv_obj_invalidate(screen);
+        lvgl_port_refresh_now();
+
+        char path[LVGL_GOLDEN_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s.png", dir, golden_scenes[s].name);
+        if (lvgl_port_screenshot_save(path)) {
+            printf("golden: %s\n", path);
+        } else {
+            printf("ERROR: Cannot write the golden scene %s\n", path);
+            ok = false;
+        }
+#if LVGL_USE_V8 == 1
+        lv_obj_del(parent);
+#else
+        lv_obj_delete(parent);
+#endif
+    }
+    lvgl_port_refresh_now();
+    return ok;
+}
@@ -0,0 +1,28 @@
+#ifndef __LVGL_PORT_GOLDEN_HPP__
+#define __LVGL_PORT_GOLDEN_HPP__
+
+#include "lvgl_port_m5stack.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *output;  // directory the scene screenshots are written to
+} lvgl_port_golden_config_t;
+
+// Makes sdl_main.cpp render the golden scenes instead of running the app and exit, called for
+// --golden <dir>. See support/golden.py
+void lvgl_port_golden_request(const lvgl_port_golden_config_t *config);
+bool lvgl_port_golden_requested(void);
+
+// Renders every golden scene once and writes what reached the panel as <output>/<scene>.png. The scenes are
+// static, without animations, so every run and render mode of a board produces the same pixels.
+// Call with the GUI lock held, returns false when a screenshot could not be written.
+bool lvgl_port_golden_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_GOLDEN_HPP__
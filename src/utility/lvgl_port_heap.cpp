@@ -0,0 +1,139 @@
+#include "lvgl_port_heap.hpp"
+#include "lvgl_port_mem.h"
+#include <cstdio>  // for fopen, fprintf
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+
+#if LV_PORT_HEAP_TIMELINE
+
+static lvgl_port_heap_sample_t heap_samples[LV_PORT_HEAP_SAMPLES];
+static uint32_t heap_count;  // samples taken, the latest LV_PORT_HEAP_SAMPLES are kept
+static uint32_t heap_last_tick;
+static const char *heap_label;
+static lv_obj_t *heap_screen;  // a screen change is sampled right away
+static const char *heap_csv_path;
+static FILE *heap_csv;
+
+static void lvgl_heap_sample(uint32_t tick)
+{
+    lvgl_port_heap_sample_t *s = &heap_samples[heap_count++ % LV_PORT_HEAP_SAMPLES];
+    s->tick                    = tick;
+    s->mark                    = heap_label;
+#if LV_PORT_MEM
+    lvgl_port_mem_stats_t mem;
+    lvgl_port_mem_get_stats(&mem);
+    s->lv_used         = (uint32_t)mem.used;
+    s->lv_max_used     = (uint32_t)mem.max_used;
+    s->lv_free_biggest = (uint32_t)mem.free_biggest;
+    s->lv_frag_pct     = mem.frag_pct;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    s->lv_used         = (uint32_t)(mon.total_size - mon.free_size);
+    s->lv_max_used     = (uint32_t)mon.max_used;
+    s->lv_free_biggest = (uint32_t)mon.free_biggest_size;
+    s->lv_frag_pct     = mon.frag_pct;
+#endif
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    s->sys_free         = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    s->sys_min_free     = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    s->sys_free_biggest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    s->psram_free       = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    s->psram_min_free   = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+#else
+    s->sys_free = s->sys_min_free = s->sys_free_biggest = s->psram_free = s->psram_min_free = 0;
+#endif
+
+    if (heap_csv) {
+        fprintf(heap_csv, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,\"%s\"\n", (unsigned)s->tick, (unsigned)s->lv_used,
+                (unsigned)s->lv_max_used, (unsigned)s->lv_free_biggest, (unsigned)s->lv_frag_pct,
+                (unsigned)s->sys_free, (unsigned)s->sys_min_free, (unsigned)s->sys_free_biggest,
+                (unsigned)s->psram_free, (unsigned)s->psram_min_free, s->mark ? s->mark : "");
+        fflush(heap_csv);  // the timeline ends whenever the emulator is closed
+    }
+    heap_last_tick = tick;
+}
+
+extern "C" void lvgl_port_heap_request_csv(const char *path)
+{
+    heap_csv_path = path;
+}
+
+extern "C" void lvgl_port_heap_start(void)
+{
+    if (heap_csv_path) {
+        heap_csv = fopen(heap_csv_path, "w");
+        if (heap_csv == NULL) {
+            printf("ERROR: Cannot write the heap timeline to %s\n", heap_csv_path);
+        } else {
+            fprintf(heap_csv, "tick_ms,lv_used,lv_max_used,lv_free_biggest,lv_frag_pct,sys_free,sys_min_free,"
+                              "sys_free_biggest,psram_free,psram_min_free,mark\n");
+        }
+    }
+    lvgl_heap_sample(lv_tick_get());
+}
+
+extern "C" void lvgl_port_heap_step(uint32_t tick)
+{
+    // Only sampled while the GUI thread runs anyway: a parked UI does not allocate, and the timeline must not
+    // keep the thread from parking
+#if LVGL_USE_V8 == 1
+    lv_obj_t *screen = lv_scr_act();
+#else
+    lv_obj_t *screen = lv_screen_active();
+#endif
+    if (screen != heap_screen || tick - heap_last_tick >= LV_PORT_HEAP_SAMPLE_MS) {
+        heap_screen = screen;
+        lvgl_heap_sample(tick);
+    }
+}
+
+extern "C" void lvgl_port_heap_mark(const char *label)
+{
+    heap_label = label;
+    lvgl_heap_sample(lv_tick_get());
+}
+
+extern "C" uint32_t lvgl_port_heap_get_timeline(lvgl_port_heap_sample_t *samples, uint32_t max)
+{
+    const uint32_t kept  = heap_count < LV_PORT_HEAP_SAMPLES ? heap_count : LV_PORT_HEAP_SAMPLES;
+    const uint32_t n     = kept < max ? kept : max;
+    const uint32_t first = heap_count - n;
+    for (uint32_t i = 0; i < n; i++) {
+        samples[i] = heap_samples[(first + i) % LV_PORT_HEAP_SAMPLES];
+    }
+    return n;
+}
+
+#else
+
+extern "C" void lvgl_port_heap_request_csv(const char *path)
+{
+    (void)path;
+}
+
+extern "C" void lvgl_port_heap_start(void)
+{
+}
+
+extern "C" void lvgl_port_heap_step(uint32_t tick)
+{
+    (void)tick;
+}
+
+extern "C" void lvgl_port_heap_mark(const char *label)
+{
+    (void)label;
+}
+
+extern "C" uint32_t lvgl_port_heap_get_timeline(lvgl_port_heap_sample_t *samples, uint32_t max)
+{
+    (void)samples;
+    (void)max;
+    return 0;
+}
+
+#endif  // LV_PORT_HEAP_TIMELINE
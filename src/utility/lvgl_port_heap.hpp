@@ -0,0 +1,63 @@
+#ifndef __LVGL_PORT_HEAP_HPP__
+#define __LVGL_PORT_HEAP_HPP__
+
+#include "lvgl.h"
+
+// 1: sample LVGL's heap, and the system heaps on the device, into a timeline (about 5.6 KB of samples)
+#ifndef LV_PORT_HEAP_TIMELINE
+#if defined(ARDUINO)
+#define LV_PORT_HEAP_TIMELINE 0
+#else
+#define LV_PORT_HEAP_TIMELINE 1
+#endif
+#endif
+
+// Sampling period [ms]. The GUI thread samples, so while it is parked there are no samples; the tick of each
+// sample shows the gaps
+#ifndef LV_PORT_HEAP_SAMPLE_MS
+#define LV_PORT_HEAP_SAMPLE_MS 1000
+#endif
+
+// Latest samples kept for lvgl_port_heap_get_timeline()
+#ifndef LV_PORT_HEAP_SAMPLES
+#define LV_PORT_HEAP_SAMPLES 128
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t tick;              // lv_tick_get() when taken
+    uint32_t lv_used;           // LVGL heap in use [bytes]
+    uint32_t lv_max_used;       // its high-water mark
+    uint32_t lv_free_biggest;   // largest free block of the LVGL heap
+    uint8_t lv_frag_pct;        // LVGL heap fragmentation
+    uint32_t sys_free;          // internal RAM heap, 0 on the emulator
+    uint32_t sys_min_free;      // its low-water mark
+    uint32_t sys_free_biggest;
+    uint32_t psram_free;        // PSRAM heap, 0 without PSRAM
+    uint32_t psram_min_free;
+    const char *mark;           // label of the latest lvgl_port_heap_mark(), NULL before the first
+} lvgl_port_heap_sample_t;
+
+// Call before lvgl_port_init(), sdl_main.cpp does for --heap-csv <file>. Every sample is appended to the file
+// as a CSV row while the app runs.
+void lvgl_port_heap_request_csv(const char *path);
+
+// Copies up to max of the latest samples, oldest first, and returns how many. Call with the GUI lock held
+uint32_t lvgl_port_heap_get_timeline(lvgl_port_heap_sample_t *samples, uint32_t max);
+
+// Samples right away and labels this and the following samples, e.g. with the screen or action that starts.
+// `label` must stay valid. Call with the GUI lock held
+void lvgl_port_heap_mark(const char *label);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_heap_start(void);
+void lvgl_port_heap_step(uint32_t tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_HEAP_HPP__
@@ -0,0 +1,276 @@
+#include "lvgl_port_latency.hpp"
+#include <atomic>
+#include <cstdio>   // for fopen, fprintf
+#include <cstdlib>  // for malloc
+#include <cstring>  // for memcpy
+
+#define LVGL_LATENCY_STR_(x) #x
+#define LVGL_LATENCY_STR(x)  LVGL_LATENCY_STR_(x)
+#define LVGL_LATENCY_TIMEOUT_MS 1000  // a touch whose frame does not arrive by then counts as lost
+#define LVGL_LATENCY_SETTLE_MS  150   // after the release, longer than the GUI thread stays awake after input
+#define LVGL_LATENCY_NO_REDRAW_MAX 3  // touches handled without any redraw before a widget counts as not redrawing
+
+typedef enum {
+    LVGL_LATENCY_MEASURED = 0,
+    LVGL_LATENCY_NO_REDRAW,  // the press was handled, but no frame redrew the widget
+    LVGL_LATENCY_LOST,       // the press did not reach the widget
+} lvgl_latency_result_t;
+
+typedef enum {
+    LVGL_LATENCY_TOTAL = 0,   // injected touch to the redrawn widget on the panel
+    LVGL_LATENCY_INDEV_WAIT,  // until the indev read took the touch
+    LVGL_LATENCY_EVENT,       // until the widget's LV_EVENT_PRESSED handler ran
+    LVGL_LATENCY_REFR_WAIT,   // until LVGL started rendering the frame
+    LVGL_LATENCY_RENDER,      // until the first flush covering the widget
+    LVGL_LATENCY_FLUSH,       // until the frame reached the panel
+    LVGL_LATENCY_STAGE_COUNT,
+} lvgl_latency_stage_t;
+
+typedef struct {
+    const char *name;
+    lv_obj_t *(*create)(lv_obj_t *parent);
+    bool touch_top;  // touch near the top edge instead of the center (the arc only reacts on its ring)
+} lvgl_latency_widget_t;
+
+static lvgl_port_latency_config_t latency_config = {NULL, 30};
+static bool latency_requested;
+static std::atomic<uint64_t> latency_event_us;  // when the touched widget handled LV_EVENT_PRESSED
+
+static lv_obj_t *lvgl_latency_button(lv_obj_t *parent)
+{
+#if LVGL_USE_V8 == 1
+    lv_obj_t *obj = lv_btn_create(parent);
+#else
+    lv_obj_t *obj = lv_button_create(parent);
+#endif
+    lv_obj_set_size(obj, 120, 50);
+    return obj;
+}
+
+static lv_obj_t *lvgl_latency_switch(lv_obj_t *parent)
+{
+    return lv_switch_create(parent);
+}
+
+static lv_obj_t *lvgl_latency_slider(lv_obj_t *parent)
+{
+    lv_obj_t *obj = lv_slider_create(parent);
+    lv_obj_set_width(obj, lv_pct(60));
+    return obj;
+}
+
+static lv_obj_t *lvgl_latency_checkbox(lv_obj_t *parent)
+{
+    return lv_checkbox_create(parent);
+}
+
+static lv_obj_t *lvgl_latency_arc(lv_obj_t *parent)
+{
+    lv_obj_t *obj = lv_arc_create(parent);
+    lv_obj_set_size(obj, 120, 120);
+    return obj;
+}
+
+static const lvgl_latency_widget_t latency_widgets[] = {
+    {"button", lvgl_latency_button, false}, {"switch", lvgl_latency_switch, false},
+    {"slider", lvgl_latency_slider, false}, {"checkbox", lvgl_latency_checkbox, false},
+    {"arc", lvgl_latency_arc, true},
+};
+
+static const char *const latency_stage_names[LVGL_LATENCY_STAGE_COUNT] = {
+    "total_us", "indev_wait_us", "event_us", "refr_wait_us", "render_us", "flush_us",
+};
+
+static void lvgl_latency_sleep(uint32_t ms)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    vTaskDelay(pdMS_TO_TICKS(ms));
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    SDL_Delay(ms);
+#endif
+}
+
+// Only takes the time, the redraw measured is the one the widget and the theme cause on press
+static void lvgl_latency_event_cb(lv_event_t *e)
+{
+    (void)e;
+    latency_event_us = lvgl_port_get_time_us();
+}
+
+static uint32_t lvgl_latency_span(uint64_t from, uint64_t to)
+{
+    return to > from ? (uint32_t)(to - from) : 0;
+}
+
+// Touches the widget once, stages are only valid when measured
+static lvgl_latency_result_t lvgl_latency_trial(const lv_area_t *area, int32_t x, int32_t y, uint32_t trial,
+                                                uint32_t *stages)
+{
+    if (!lvgl_port_lock()) {
+        return LVGL_LATENCY_LOST;
+    }
+    lvgl_port_probe_arm(area);
+    latency_event_us = 0;
+    lvgl_port_unlock();
+
+    // Spread the touches over the phases of the indev read and refresh timers
+    lvgl_latency_sleep((trial * 7) % 23);
+    uint64_t inject_us;
+    if (!lvgl_port_inject_touch(x, y, true, &inject_us)) {
+        return LVGL_LATENCY_LOST;
+    }
+    lvgl_port_probe_t probe;
+    bool done = false;
+    for (uint32_t ms = 0; ms < LVGL_LATENCY_TIMEOUT_MS && !(done = lvgl_port_probe_done(&probe)); ms++) {
+        lvgl_latency_sleep(1);
+    }
+    const bool handled = latency_event_us != 0;
+    lvgl_port_inject_touch(x, y, false, NULL);
+    lvgl_latency_sleep(LVGL_LATENCY_SETTLE_MS);
+    if (!done) {
+        return handled ? LVGL_LATENCY_NO_REDRAW : LVGL_LATENCY_LOST;
+    }
+
+    const uint64_t event_us         = latency_event_us ? latency_event_us.load() : probe.read_us;
+    stages[LVGL_LATENCY_TOTAL]      = lvgl_latency_span(inject_us, probe.done_us);
+    stages[LVGL_LATENCY_INDEV_WAIT] = lvgl_latency_span(inject_us, probe.read_us);
+    stages[LVGL_LATENCY_EVENT]      = lvgl_latency_span(probe.read_us, event_us);
+    stages[LVGL_LATENCY_REFR_WAIT]  = lvgl_latency_span(event_us, probe.render_us);
+    stages[LVGL_LATENCY_RENDER]     = lvgl_latency_span(probe.render_us, probe.flush_us);
+    stages[LVGL_LATENCY_FLUSH]      = lvgl_latency_span(probe.flush_us, probe.done_us);
+    return LVGL_LATENCY_MEASURED;
+}
+
+// Sorts values in place
+static void lvgl_latency_write_dist(FILE *f, const char *name, uint32_t *values, uint32_t n)
+{
+    lvgl_port_stat_t stat;
+    lvgl_port_stats_summarize(values, n, &stat);
+    fprintf(f, ", \"%s\": {\"mean\": %u, \"p50\": %u, \"p95\": %u, \"p99\": %u, \"max\": %u}", name,
+            (unsigned)stat.mean, (unsigned)stat.p50, (unsigned)stat.p95, (unsigned)stat.p99, (unsigned)stat.max);
+}
+
+extern "C" void lvgl_port_latency_request(const lvgl_port_latency_config_t *config)
+{
+    latency_config.output = config->output;
+    if (config->trials) {
+        latency_config.trials = config->trials;
+    }
+    latency_requested = true;
+}
+
+extern "C" bool lvgl_port_latency_requested(void)
+{
+    return latency_requested;
+}
+
+extern "C" bool lvgl_port_latency_run(void)
+{
+    const char *path     = latency_config.output ? latency_config.output : "-";
+    const bool to_stdout = (path[0] == '-' && path[1] == '\0');
+    const uint32_t n     = latency_config.trials;
+    uint32_t *stages     = (uint32_t *)malloc(LVGL_LATENCY_STAGE_COUNT * n * sizeof(uint32_t));
+    uint32_t *values     = (uint32_t *)malloc(n * sizeof(uint32_t));
+    FILE *f              = (stages && values) ? (to_stdout ? stdout : fopen(path, "w")) : NULL;
+    if (f == NULL) {
+        printf("ERROR: Cannot write latency results to %s\n", path);
+        free(stages);
+        free(values);
+        return false;
+    }
+
+    lv_obj_t *screen = NULL;
+    if (lvgl_port_lock()) {
+#if LVGL_USE_V8 == 1
+        screen = lv_scr_act();
+#else
+        screen = lv_screen_active();
+#endif
+        fprintf(f, "{\n  \"lvgl\": \"%d.%d.%d\",", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+#ifdef M5GFX_BOARD
+        fprintf(f, " \"board\": \"%s\",", LVGL_LATENCY_STR(M5GFX_BOARD));
+#endif
+        fprintf(f, " \"width\": %d, \"height\": %d, \"trials\": %u,\n  \"widgets\": [",
+                (int)lv_obj_get_width(screen), (int)lv_obj_get_height(screen), (unsigned)n);
+        lvgl_port_unlock();
+    }
+
+    uint32_t measured = 0;
+    for (size_t w = 0; w < sizeof(latency_widgets) / sizeof(latency_widgets[0]) && screen; w++) {
+        const lvgl_latency_widget_t *widget = &latency_widgets[w];
+        if (!lvgl_port_lock()) {
+            break;
+        }
+        lv_obj_t *obj = widget->create(screen);
+        lv_obj_center(obj);
+        lv_obj_add_event_cb(obj, lvgl_latency_event_cb, LV_EVENT_PRESSED, NULL);
+        lvgl_port_refresh_now();
+        lv_area_t area;
+        lv_obj_get_coords(obj, &area);
+        lvgl_port_unlock();
+        lvgl_latency_sleep(LVGL_LATENCY_SETTLE_MS);
+
+        const int32_t x = (area.x1 + area.x2) / 2;
+        const int32_t y = widget->touch_top ? area.y1 + 8 : (area.y1 + area.y2) / 2;
+        uint32_t ok = 0, no_redraw = 0, lost = 0;
+        for (uint32_t t = 0; t < n; t++) {
+            uint32_t trial[LVGL_LATENCY_STAGE_COUNT];
+            const lvgl_latency_result_t res = lvgl_latency_trial(&area, x, y, t, trial);
+            if (res == LVGL_LATENCY_LOST) {
+                lost++;
+                continue;
+            }
+            if (res == LVGL_LATENCY_NO_REDRAW) {
+                if (++no_redraw >= LVGL_LATENCY_NO_REDRAW_MAX && ok == 0) {
+                    break;  // the widget does not redraw on press, there is nothing to measure
+                }
+                continue;
+            }
+            for (int s = 0; s < LVGL_LATENCY_STAGE_COUNT; s++) {
+                stages[s * n + ok] = trial[s];
+            }
+            ok++;
+        }
+        measured += ok;
+        const bool redraws = ok > 0 || no_redraw == 0;
+
+        fprintf(f,
+                "%s\n    {\"name\": \"%s\", \"redraws_on_press\": %s, \"trials\": %u, \"no_redraw\": %u, "
+                "\"lost\": %u",
+                w ? "," : "", widget->name, redraws ? "true" : "false", (unsigned)ok, (unsigned)no_redraw,
+                (unsigned)lost);
+        // Widgets that do not redraw on press have no latency to report
+        for (int s = 0; s < LVGL_LATENCY_STAGE_COUNT && redraws; s++) {
+            memcpy(values, &stages[s * n], ok * sizeof(uint32_t));
+            lvgl_latency_write_dist(f, latency_stage_names[s], values, ok);
+        }
+        fprintf(f, "}");
+        if (!to_stdout && !redraws) {
+            printf("latency: %-10s does not redraw on press\n", widget->name);
+        } else if (!to_stdout) {
+            lvgl_port_stat_t total;
+            memcpy(values, &stages[LVGL_LATENCY_TOTAL * n], ok * sizeof(uint32_t));
+            lvgl_port_stats_summarize(values, ok, &total);
+            printf("latency: %-10s p50 %6u us, p95 %6u us, %u lost\n", widget->name, (unsigned)total.p50,
+                   (unsigned)total.p95, (unsigned)lost);
+        }
+
+        if (lvgl_port_lock()) {
+#if LVGL_USE_V8 == 1
+            lv_obj_del(obj);
+#else
+            lv_obj_delete(obj);
+#endif
+            lvgl_port_unlock();
+        }
+    }
+    fprintf(f, "\n  ]\n}\n");
+    free(stages);
+    free(values);
+
+    bool ok = !ferror(f) && measured > 0;
+    if (!to_stdout) {
+        ok = (fclose(f) == 0) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,30 @@
+#ifndef __LVGL_PORT_LATENCY_HPP__
+#define __LVGL_PORT_LATENCY_HPP__
+
+#include "lvgl_port_m5stack.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *output;  // JSON result file, "-" for stdout
+    uint32_t trials;     // touches per widget
+} lvgl_port_latency_config_t;
+
+// Makes sdl_main.cpp measure touch-to-photon latency instead of running the app and exit, called for
+// --latency <file>. Zero fields keep their defaults.
+void lvgl_port_latency_request(const lvgl_port_latency_config_t *config);
+bool lvgl_port_latency_requested(void);
+
+// Touches a series of widgets through the port's input queue and writes the latency distribution from the
+// injected touch to the redrawn widget reaching the panel, split into indev wait, event handling, refresh wait,
+// render and flush. Headless only (see lvgl_port_inject_touch()). Call WITHOUT the GUI lock, the GUI thread has
+// to run meanwhile. Returns false when the results could not be written or no touch got through.
+bool lvgl_port_latency_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_LATENCY_HPP__
@@ -1,6 +1,20 @@
 #include "lvgl_port_m5stack.hpp"
+#include "lvgl_port_rgb565.hpp"
+#include "lvgl_port_stats.hpp"
+#include "lvgl_port_post.hpp"
+#include "lvgl_port_session.hpp"
+#include "lvgl_port_heap.hpp"
+#include "lvgl_port_cache.hpp"
+#include "lvgl_port_glyph.hpp"
+#include "lvgl_port_pack.hpp"
+#include "lvgl_port_fs.hpp"
+#include "lvgl_port_gif.hpp"
+#include "lvgl_port_tick.h"
 #include <cstdlib>  // for aligned_alloc
+#include <cstdio>   // for printf
 #include <cstring>  // for memset
+#include <atomic>
+#include <mutex>
 
 #ifdef USE_EEZ_STUDIO
 #include "ui/ui.h"
@@ -8,164 +22,1517 @@
 
 #if defined(ARDUINO) && defined(ESP_PLATFORM)
 static SemaphoreHandle_t xGuiSemaphore;
+static TaskHandle_t xGuiTask;
 #elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-static SDL_mutex *xGuiMutex;
+static SDL_sem *xGuiLock;  // binary semaphore, SDL mutexes have no timed lock
+static SDL_sem *xGuiWake;
 #endif
 
 #ifndef LV_BUFFER_LINE
 #define LV_BUFFER_LINE 120
 #endif
 
+// 1: copy flushed areas straight into the panel framebuffer (emulator only, Panel_sdl is memory backed)
+#ifndef LV_PORT_DIRECT_FLUSH
+#if !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+#define LV_PORT_DIRECT_FLUSH 1
+#else
+#define LV_PORT_DIRECT_FLUSH 0
+#endif
+#endif
+
+// 1: print the number of areas and pixels sent to the panel after every frame
+#ifndef LV_PORT_FRAME_LOG
+#define LV_PORT_FRAME_LOG 0
+#endif
+
+// 1: hand flushed areas to a transfer thread so LVGL can render into the second buffer meanwhile
+#ifndef LV_PORT_ASYNC_FLUSH
+#define LV_PORT_ASYNC_FLUSH 0
+#endif
+
+// Default render mode, see lvgl_port_render_mode_t (0: partial, 1: direct, 2: full)
+#ifndef LV_PORT_RENDER_MODE
+#define LV_PORT_RENDER_MODE 0
+#endif
+
+// 1: LVGL time only advances when the GUI thread steps to the next timer deadline, which it does without
+// waiting for it. Runs go as fast as rendering allows and repeat the same frames (meant for the emulator).
+#ifndef LV_PORT_VIRTUAL_CLOCK
+#define LV_PORT_VIRTUAL_CLOCK 0
+#endif
+
+#if LVGL_USE_V8 == 1 && !LV_TICK_CUSTOM
+#error "lv_conf.h: the port is LVGL's tick source, set LV_TICK_CUSTOM to 1 with lvgl_port_tick_get()"
+#endif
+
+// 1: render into a memory framebuffer instead of the panel, see lvgl_port_set_headless()
+#ifndef LV_PORT_HEADLESS
+#define LV_PORT_HEADLESS 0
+#endif
+
+// Time the GUI thread spends on lvgl_port_post() closures before each lv_timer_handler() call [us]
+#ifndef LV_PORT_POST_BUDGET_US
+#define LV_PORT_POST_BUDGET_US 2000
+#endif
+
+// Refresh period while animations run or the screen is touched [ms]
+#ifndef LV_PORT_REFR_PERIOD_ACTIVE
+#define LV_PORT_REFR_PERIOD_ACTIVE 16
+#endif
+
+// Refresh period of a static UI [ms]
+#ifndef LV_PORT_REFR_PERIOD_IDLE
+#if LVGL_USE_V8 == 1
+#define LV_PORT_REFR_PERIOD_IDLE LV_DISP_DEF_REFR_PERIOD
+#else
+#define LV_PORT_REFR_PERIOD_IDLE LV_DEF_REFR_PERIOD
+#endif
+#endif
+
+// 1: pick the stripe height and single/double buffering of partial mode with a calibration render at startup
+#ifndef LV_PORT_BUFFER_AUTOTUNE
+#define LV_PORT_BUFFER_AUTOTUNE 0
+#endif
+
+// Draw buffer memory the autotuner may use [bytes], 0: what LV_BUFFER_LINE takes today
+#ifndef LV_PORT_BUFFER_BUDGET
+#define LV_PORT_BUFFER_BUDGET 0
+#endif
+
+// 1: a sampler thread queues every touch change with its time, the indev read hands all of them to LVGL in order.
+// Opt-in on the device: the touch controller shares its I2C bus with the PMIC and IMU on several boards.
+#ifndef LV_PORT_INPUT_QUEUE
+#if defined(ARDUINO)
+#define LV_PORT_INPUT_QUEUE 0
+#else
+#define LV_PORT_INPUT_QUEUE 1
+#endif
+#endif
+
+// Touch sampling period of the input queue while the panel is touched [ms]
+#ifndef LV_PORT_TOUCH_SAMPLE_MS
+#define LV_PORT_TOUCH_SAMPLE_MS 5
+#endif
+
+// 1: keep wait and hold times per GUI lock holder, name holders that keep the lock past the budget
+#ifndef LV_PORT_LOCK_PROFILE
+#define LV_PORT_LOCK_PROFILE 0
+#endif
+
+// Longest the GUI lock may be held outside the GUI thread before LV_PORT_LOCK_PROFILE warns [ms]
+#ifndef LV_PORT_LOCK_HOLD_BUDGET_MS
+#define LV_PORT_LOCK_HOLD_BUDGET_MS 50
+#endif
+
+// With LVGL's OS layer enabled (LV_PORT_DRAW_UNITS > 1 on v9) the GUI lock also holds lv_lock(), so threads
+// using either lock exclude each other and lv_timer_handler() finds its own lock already taken
+#if LVGL_USE_V9 == 1 && LV_USE_OS != LV_OS_NONE
+#define LVGL_PORT_LV_LOCK 1
+#else
+#define LVGL_PORT_LV_LOCK 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-static void lvgl_tick_timer(void *arg)
+uint64_t lvgl_port_get_time_us(void);
+
+// Set on pointer input, the GUI thread then reads the indev right away
+static std::atomic<bool> input_event;
+
+static const char gui_thread_label[] = "lvgl_gui_thread";
+
+// The touch controller, read by the sampler or the indev read and by apps through lvgl_port_touch_lock().
+// Its own lock, so touch reads do not wait for rendering nor show up in the GUI lock profile
+static std::mutex touch_mutex;
+
+// Current holder of the GUI lock, also read without the lock while waiting for it
+static std::atomic<const char *> lock_holder_label;
+static std::atomic<void *> lock_holder_caller;  // return address into the caller of the lock function
+static std::atomic<uint32_t> lock_acquired_us;  // low bits of lvgl_port_get_time_us()
+static uint32_t lock_wait_us;                   // how long the current holder waited
+
+#if LV_PORT_LOCK_PROFILE
+#define LVGL_LOCK_PROFILE_MAX 16
+
+typedef struct {
+    const char *label;
+    void *caller;  // holders without a label are told apart by their call site
+    uint32_t count;
+    uint32_t over_budget;
+    uint32_t max_wait_us;
+    uint32_t max_hold_us;
+    uint64_t wait_us;
+    uint64_t hold_us;
+} lvgl_lock_profile_t;
+
+static lvgl_lock_profile_t lock_profile[LVGL_LOCK_PROFILE_MAX];
+
+static void lvgl_lock_holder_name(const char *label, void *caller, char *buf, size_t len)
+{
+    if (label) {
+        snprintf(buf, len, "%s", label);
+    } else {
+        snprintf(buf, len, "caller %p", caller);
+    }
+}
+
+// Books one acquisition, called with the GUI lock still held
+static void lvgl_lock_profile_add(const char *label, void *caller, uint32_t wait_us, uint32_t hold_us)
+{
+    lvgl_lock_profile_t *p = NULL;
+    for (uint32_t i = 0; i < LVGL_LOCK_PROFILE_MAX && p == NULL; i++) {
+        lvgl_lock_profile_t *e = &lock_profile[i];
+        if (e->count == 0 || (e->label == label && (label || e->caller == caller))) {
+            p = e;
+        }
+    }
+    if (p == NULL) {
+        p = &lock_profile[LVGL_LOCK_PROFILE_MAX - 1];  // table full, the last row collects the rest
+    }
+    if (p->count == 0) {
+        p->label  = label;
+        p->caller = caller;
+    }
+    p->count++;
+    p->wait_us += wait_us;
+    p->hold_us += hold_us;
+    p->max_wait_us = LV_MAX(p->max_wait_us, wait_us);
+    p->max_hold_us = LV_MAX(p->max_hold_us, hold_us);
+
+    if (label != gui_thread_label && hold_us > LV_PORT_LOCK_HOLD_BUDGET_MS * 1000) {
+        char name[48];
+        lvgl_lock_holder_name(label, caller, name, sizeof(name));
+        printf("WARNING: GUI lock held for %u ms by %s (budget %u ms)\n", (unsigned)(hold_us / 1000), name,
+               (unsigned)LV_PORT_LOCK_HOLD_BUDGET_MS);
+        p->over_budget++;
+    }
+}
+#endif
+
+// One attempt at the platform lock, timeout_ms 0 only tries
+static bool lvgl_port_lock_platform(uint32_t timeout_ms)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    TickType_t ticks = (timeout_ms == LVGL_PORT_LOCK_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTake(xGuiSemaphore, ticks) == pdTRUE;
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    if (timeout_ms == LVGL_PORT_LOCK_FOREVER) {
+        return SDL_SemWait(xGuiLock) == 0;
+    }
+    if (timeout_ms == 0) {
+        return SDL_SemTryWait(xGuiLock) == 0;
+    }
+    return SDL_SemWaitTimeout(xGuiLock, timeout_ms) == 0;
+#endif
+}
+
+// Takes the GUI lock, records the wait and who holds it now
+static bool lvgl_port_take_gui_lock(const char *label, void *caller, uint32_t timeout_ms)
+{
+    uint64_t t0 = lvgl_port_get_time_us();
+    bool ok;
+#if LV_PORT_LOCK_PROFILE
+    if (label == gui_thread_label) {
+        // Wait in budget sized steps and name whoever keeps lv_timer_handler() from running
+        while (!(ok = lvgl_port_lock_platform(LV_PORT_LOCK_HOLD_BUDGET_MS))) {
+            char name[48];
+            lvgl_lock_holder_name(lock_holder_label, lock_holder_caller, name, sizeof(name));
+            printf("WARNING: GUI thread waiting %u ms, GUI lock held by %s\n",
+                   (unsigned)((lvgl_port_get_time_us() - t0) / 1000), name);
+        }
+    } else
+#endif
+    {
+        ok = lvgl_port_lock_platform(timeout_ms);
+    }
+    if (!ok) {
+        return false;
+    }
+#if LVGL_PORT_LV_LOCK
+    lv_lock();  // only waits for threads calling lv_lock() directly
+#endif
+
+    uint64_t now       = lvgl_port_get_time_us();
+    lock_wait_us       = (uint32_t)(now - t0);
+    lock_holder_label  = label;
+    lock_holder_caller = caller;
+    lock_acquired_us   = (uint32_t)now;
+#if LV_PORT_STATS
+    lvgl_port_stats_record(LVGL_PORT_STAT_LOCK_WAIT_US, lock_wait_us);
+#endif
+    return true;
+}
+
+static void lvgl_port_give_gui_lock(void)
+{
+    uint32_t hold_us = (uint32_t)lvgl_port_get_time_us() - lock_acquired_us;
+#if LV_PORT_STATS
+    lvgl_port_stats_record(LVGL_PORT_STAT_LOCK_HOLD_US, hold_us);
+#endif
+#if LV_PORT_LOCK_PROFILE
+    lvgl_lock_profile_add(lock_holder_label, lock_holder_caller, lock_wait_us, hold_us);
+#else
+    (void)hold_us;
+#endif
+    lock_holder_label  = NULL;
+    lock_holder_caller = NULL;
+#if LVGL_PORT_LV_LOCK
+    lv_unlock();
+#endif
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    xSemaphoreGive(xGuiSemaphore);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    SDL_SemPost(xGuiLock);
+#endif
+}
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static uint32_t lvgl_port_gui_step(void);
+
+static void lvgl_rtos_task(void *pvParameter)
+{
+    (void)pvParameter;
+    while (1) {
+        uint32_t sleep_ms = LV_NO_TIMER_READY;
+        if (lvgl_port_take_gui_lock(gui_thread_label, NULL, LVGL_PORT_LOCK_FOREVER)) {
+            sleep_ms = lvgl_port_gui_step();
+#ifdef USE_EEZ_STUDIO
+            ui_tick();
+            sleep_ms = LV_MIN(sleep_ms, 10);  // ui_tick() polls the flow variables
+#endif
+            lvgl_port_give_gui_lock();
+        }
+        // Until the next LVGL timer is due or lvgl_port_wake(), at least one tick so the idle task gets to run
+        TickType_t ticks = (sleep_ms == LV_NO_TIMER_READY) ? portMAX_DELAY : pdMS_TO_TICKS(sleep_ms);
+        ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+    }
+}
+
+void lvgl_port_wake(void)
+{
+    if (xGuiTask) {
+        xTaskNotifyGive(xGuiTask);
+    }
+}
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static uint32_t lvgl_port_gui_step(void);
+#if LV_PORT_INPUT_QUEUE
+static void lvgl_input_kick(void);
+#endif
+
+static int lvgl_sdl_thread(void *data)
+{
+    (void)data;
+    while (1) {
+        uint32_t sleep_ms = LV_NO_TIMER_READY;
+        if (lvgl_port_take_gui_lock(gui_thread_label, NULL, LVGL_PORT_LOCK_FOREVER)) {
+            sleep_ms = lvgl_port_gui_step();
+            lvgl_port_give_gui_lock();
+        }
+        // Until the next LVGL timer is due or lvgl_port_wake()
+        if (sleep_ms == LV_NO_TIMER_READY) {
+            SDL_SemWait(xGuiWake);
+        } else {
+            SDL_SemWaitTimeout(xGuiWake, sleep_ms);
+        }
+        while (SDL_SemTryWait(xGuiWake) == 0) {
+        }
+    }
+    return 0;
+}
+
+void lvgl_port_wake(void)
+{
+    if (xGuiWake && SDL_SemValue(xGuiWake) == 0) {
+        SDL_SemPost(xGuiWake);
+    }
+}
+
+// Runs on the thread pumping SDL events, wakes the GUI thread for pointer input
+static int lvgl_sdl_event_watch(void *userdata, SDL_Event *event)
+{
+    (void)userdata;
+    switch (event->type) {
+        case SDL_MOUSEMOTION:
+            if (event->motion.state == 0) {
+                break;  // hovering
+            }
+            // fall through
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+#if LV_PORT_INPUT_QUEUE
+            lvgl_input_kick();  // the sampler reports it once Panel_sdl has seen the event
+#else
+            input_event = true;
+            lvgl_port_wake();
+#endif
+            break;
+        default:
+            break;
+    }
+    return 1;
+}
+#endif
+
+#if LVGL_USE_V8 == 1 || LVGL_USE_V9 == 1
+#if LVGL_USE_V8 == 1
+typedef lv_disp_drv_t lvgl_port_disp_t;
+#else
+typedef lv_display_t lvgl_port_disp_t;
+#endif
+
+typedef struct {
+    lvgl_port_disp_t *disp;
+    M5GFX *gfx;
+    lv_area_t area;
+    void *px_map;             // first pixel of the area
+    int32_t stride;           // [pixels]
+    bool last;                // last area of the frame
+    bool ready;               // signal flush_ready when done
+    bool probe;               // completes the frame the latency probe waits for
+    uint32_t render_us;       // valid for the last area of a frame
+    uint64_t frame_start_us;  // valid for the last area of a frame
+} lvgl_flush_job_t;
+
+// Last completed frame, written by the flush side (the transfer thread in async mode) and read by any thread.
+// frame_info_seq is odd while it is being written, readers retry until they copied it between two equal values.
+static lvgl_port_frame_info_t frame_info;
+static std::atomic<uint32_t> frame_info_seq;
+
+// Frame in progress, touched by the flush side only
+static uint32_t frame_count;
+static uint32_t frame_areas;
+static uint32_t frame_pixels;
+static uint32_t frame_flush_us;
+static uint32_t frame_convert_us;
+static bool frame_in_write;
+
+static lvgl_port_render_mode_t render_mode = (lvgl_port_render_mode_t)LV_PORT_RENDER_MODE;
+
+// Headless backend, frames end up in a plain framebuffer in the panel byte order
+static bool headless = LV_PORT_HEADLESS;
+static uint16_t *headless_fb;
+static int32_t headless_w;
+static int32_t headless_h;
+
+// Dirty areas of the current frame in direct mode, presented together on the last flush
+#define LVGL_DIRECT_AREA_MAX 32
+static lv_area_t direct_areas[LVGL_DIRECT_AREA_MAX];
+static uint32_t direct_area_cnt;
+// Areas are converted to the panel byte order in here: a whole screen with LV_PORT_DIRECT_FLUSH, which sends
+// each area with one pushImage(), one row of the screen otherwise
+static uint16_t *direct_buf;
+
+// GUI thread side of the frame timing
+static uint64_t frame_start_us;
+static uint64_t render_mark_us;
+static uint32_t frame_render_us;
+
+// Touch-to-photon probe, see lvgl_port_probe_arm()
+static lv_area_t probe_area;
+static lvgl_port_probe_t probe;
+static bool probe_armed;  // until the frame that first drew probe_area after the touch read is submitted
+static std::atomic<uint64_t> probe_done_us;  // set by the flush side once that frame reached the panel
+
+uint64_t lvgl_port_get_time_us(void)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    return esp_timer_get_time();
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    static const uint64_t freq = SDL_GetPerformanceFrequency();
+    return SDL_GetPerformanceCounter() * 1000000ULL / freq;
+#endif
+}
+
+#if LV_PORT_VIRTUAL_CLOCK
+static std::atomic<uint32_t> virtual_ms;  // advanced by the GUI thread, read by every thread taking a tick
+static uint32_t virtual_step;             // where the last step left the next deadline, GUI thread only
+#endif
+
+uint32_t lvgl_port_tick_get(void)
+{
+#if LV_PORT_VIRTUAL_CLOCK
+    return virtual_ms.load(std::memory_order_relaxed);
+#else
+    return (uint32_t)(lvgl_port_get_time_us() / 1000);
+#endif
+}
+
+static void lvgl_port_flush_ready(lvgl_port_disp_t *disp)
+{
+#if LVGL_USE_V8 == 1
+    lv_disp_flush_ready(disp);
+#else
+    lv_display_flush_ready(disp);
+#endif
+}
+
+// Converts LVGL's RGB565 to the panel byte order, dst may be equal to src
+static void lvgl_port_swap_pixels(uint16_t *dst, const uint16_t *src, uint32_t count)
+{
+#if LVGL_USE_V8 == 1 && LV_COLOR_16_SWAP
+    // LVGL already renders in the panel byte order
+    if (dst != src) {
+        memcpy(dst, src, count * sizeof(uint16_t));
+    }
+#else
+    uint64_t t0 = lvgl_port_get_time_us();
+    lvgl_port_rgb565_swap(dst, src, count);
+    frame_convert_us += (uint32_t)(lvgl_port_get_time_us() - t0);
+#endif
+}
+
+// The panel transaction is opened on the first area of a frame and closed on the last one,
+// so LVGL flushing a dozen small areas costs one startWrite()/endWrite() pair instead of a dozen.
+// Pixels go out in the panel byte order, so M5GFX sends them as they are without its own conversion.
+static void lvgl_port_flush_area(M5GFX &gfx, const lv_area_t *area, void *px_map, int32_t stride, bool last)
+{
+    int32_t w       = (area->x2 - area->x1 + 1);
+    int32_t h       = (area->y2 - area->y1 + 1);
+    uint32_t pixels = w * h;
+    uint16_t *px    = (uint16_t *)px_map;
+
+    if (headless_fb) {
+        // No panel to talk to, convert straight into the memory framebuffer
+        uint16_t *dst = headless_fb + area->y1 * headless_w + area->x1;
+        for (int32_t y = 0; y < h; y++, px += stride, dst += headless_w) {
+            lvgl_port_swap_pixels(dst, px, w);
+        }
+        frame_areas++;
+        frame_pixels += pixels;
+        return;
+    }
+
+    if (!frame_in_write) {
+        gfx.startWrite();
+        frame_in_write = true;
+    }
+
+    if (render_mode != LVGL_PORT_RENDER_DIRECT) {
+        // The draw buffer is rendered again for every area, swap it in place and send it in one go
+        lvgl_port_swap_pixels(px, px, pixels);
+#if LV_PORT_DIRECT_FLUSH
+        // Panel_sdl keeps its framebuffer in memory, so a single pushImage() lets the panel copy each row
+        // of the area straight into its backing store. No address window, no pixel stream, no chunking.
+        gfx.pushImage(area->x1, area->y1, w, h, (const lgfx::swap565_t *)px);
+#else
+        gfx.setAddrWindow(area->x1, area->y1, w, h);
+        gfx.writePixels((const lgfx::swap565_t *)px, pixels);
+#endif
+    } else {
+        // Area inside a full screen framebuffer (direct render mode) which LVGL keeps drawing on,
+        // convert it into the scratch buffer
+#if LV_PORT_DIRECT_FLUSH
+        uint16_t *dst = direct_buf;
+        for (int32_t y = 0; y < h; y++, px += stride, dst += w) {
+            lvgl_port_swap_pixels(dst, px, w);
+        }
+        gfx.pushImage(area->x1, area->y1, w, h, (const lgfx::swap565_t *)direct_buf);
+#else
+        // One row at a time, the pixels stream through a single address window
+        gfx.setAddrWindow(area->x1, area->y1, w, h);
+        for (int32_t y = 0; y < h; y++, px += stride) {
+            lvgl_port_swap_pixels(direct_buf, px, w);
+            gfx.writePixels((const lgfx::swap565_t *)direct_buf, w);
+        }
+#endif
+    }
+
+    frame_areas++;
+    frame_pixels += pixels;
+
+    if (last) {
+        gfx.endWrite();
+        frame_in_write = false;
+    }
+}
+
+// Single writer: the flush side
+static void lvgl_port_frame_info_publish(const lvgl_port_frame_info_t *info)
+{
+    const uint32_t seq = frame_info_seq.load(std::memory_order_relaxed);
+    frame_info_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    frame_info = *info;
+    frame_info_seq.store(seq + 2, std::memory_order_release);
+}
+
+// Runs on the GUI thread in synchronous mode and on the transfer thread in async mode
+static void lvgl_port_flush_job(const lvgl_flush_job_t *job)
+{
+    uint64_t t0 = lvgl_port_get_time_us();
+    lvgl_port_flush_area(*job->gfx, &job->area, job->px_map, job->stride, job->last);
+    uint64_t t1 = lvgl_port_get_time_us();
+    frame_flush_us += (uint32_t)(t1 - t0);
+
+    if (job->last) {
+        lvgl_port_frame_info_t info;
+        info.frame      = ++frame_count;
+        info.areas      = frame_areas;
+        info.pixels     = frame_pixels;
+        info.render_us  = job->render_us;
+        info.flush_us   = frame_flush_us;
+        info.frame_us   = (uint32_t)(t1 - job->frame_start_us);
+        info.convert_us = frame_convert_us;
+        lvgl_port_frame_info_publish(&info);
+        if (job->probe) {
+            probe_done_us.store(t1, std::memory_order_release);
+        }
+#if LV_PORT_STATS
+        lvgl_port_stats_record(LVGL_PORT_STAT_RENDER_US, info.render_us);
+        lvgl_port_stats_record(LVGL_PORT_STAT_FLUSH_US, info.flush_us);
+        lvgl_port_stats_record(LVGL_PORT_STAT_FRAME_US, info.frame_us);
+        lvgl_port_stats_record(LVGL_PORT_STAT_PIXELS, info.pixels);
+        lvgl_port_stats_record(LVGL_PORT_STAT_AREAS, info.areas);
+#endif
+        frame_areas      = 0;
+        frame_pixels     = 0;
+        frame_flush_us   = 0;
+        frame_convert_us = 0;
+#if LV_PORT_FRAME_LOG
+        // bytes per microsecond is MB/s
+        printf("frame %u: %u areas, %u pixels, render %u us, flush %u us, total %u us, convert %u MB/s\n",
+               (unsigned)info.frame, (unsigned)info.areas, (unsigned)info.pixels, (unsigned)info.render_us,
+               (unsigned)info.flush_us, (unsigned)info.frame_us,
+               info.convert_us ? (unsigned)(info.pixels * 2 / info.convert_us) : 0);
+#endif
+    }
+
+    if (job->ready) {
+        lvgl_port_flush_ready(job->disp);
+    }
+}
+
+#if LV_PORT_ASYNC_FLUSH
+// LVGL keeps at most one buffer in flight, the queue only needs a little slack
+#define LVGL_FLUSH_QUEUE_LEN 4
+
+static std::atomic<uint32_t> flush_pending;
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static QueueHandle_t xFlushQueue;
+static SemaphoreHandle_t xFlushDone;
+
+static void lvgl_flush_queue_init(void)
+{
+    xFlushQueue = xQueueCreate(LVGL_FLUSH_QUEUE_LEN, sizeof(lvgl_flush_job_t));
+    xFlushDone  = xSemaphoreCreateBinary();
+}
+
+static void lvgl_flush_queue_push(const lvgl_flush_job_t *job)
+{
+    xQueueSend(xFlushQueue, job, portMAX_DELAY);
+}
+
+static void lvgl_flush_queue_pop(lvgl_flush_job_t *job)
+{
+    xQueueReceive(xFlushQueue, job, portMAX_DELAY);
+}
+
+static void lvgl_flush_done_post(void)
+{
+    xSemaphoreGive(xFlushDone);
+}
+
+static void lvgl_flush_done_wait(void)
+{
+    xSemaphoreTake(xFlushDone, pdMS_TO_TICKS(1));
+}
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static lvgl_flush_job_t flush_jobs[LVGL_FLUSH_QUEUE_LEN];
+static uint32_t flush_job_head;  // written by the GUI thread only
+static uint32_t flush_job_tail;  // written by the transfer thread only
+static SDL_sem *xFlushJobs;
+static SDL_sem *xFlushSlots;
+static SDL_sem *xFlushDone;
+
+static void lvgl_flush_queue_init(void)
+{
+    xFlushJobs  = SDL_CreateSemaphore(0);
+    xFlushSlots = SDL_CreateSemaphore(LVGL_FLUSH_QUEUE_LEN);
+    xFlushDone  = SDL_CreateSemaphore(0);
+}
+
+static void lvgl_flush_queue_push(const lvgl_flush_job_t *job)
+{
+    SDL_SemWait(xFlushSlots);
+    flush_jobs[flush_job_head++ % LVGL_FLUSH_QUEUE_LEN] = *job;
+    SDL_SemPost(xFlushJobs);
+}
+
+static void lvgl_flush_queue_pop(lvgl_flush_job_t *job)
+{
+    SDL_SemWait(xFlushJobs);
+    *job = flush_jobs[flush_job_tail++ % LVGL_FLUSH_QUEUE_LEN];
+    SDL_SemPost(xFlushSlots);
+}
+
+static void lvgl_flush_done_post(void)
+{
+    SDL_SemPost(xFlushDone);
+}
+
+static void lvgl_flush_done_wait(void)
+{
+    SDL_SemWaitTimeout(xFlushDone, 1);
+}
+#endif
+
+// Stands in for the DMA engine: drains flush jobs while LVGL renders into the other draw buffer
+static void lvgl_flush_worker(void)
+{
+    lvgl_flush_job_t job;
+    while (1) {
+        lvgl_flush_queue_pop(&job);
+        lvgl_port_flush_job(&job);
+        flush_pending--;
+        lvgl_flush_done_post();
+    }
+}
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static void lvgl_flush_task(void *pvParameter)
+{
+    (void)pvParameter;
+    lvgl_flush_worker();
+}
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static int lvgl_flush_thread(void *data)
+{
+    (void)data;
+    lvgl_flush_worker();
+    return 0;
+}
+#endif
+
+static void lvgl_port_flush_start(void)
+{
+    lvgl_flush_queue_init();
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    xTaskCreate(lvgl_flush_task, "lvgl_flush_task", 4096, NULL, 2, NULL);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    SDL_CreateThread(lvgl_flush_thread, "lvgl_flush_thread", NULL);
+#endif
+}
+#endif
+
+// Called by LVGL before it starts rendering the invalidated areas of a frame
+static void lvgl_port_render_start(void)
+{
+    frame_start_us  = lvgl_port_get_time_us();
+    render_mark_us  = frame_start_us;
+    frame_render_us = 0;
+}
+
+// Called by LVGL when it wants to reuse a buffer that may still be in flight
+static void lvgl_port_flush_wait(void)
+{
+#if LV_PORT_ASYNC_FLUSH
+    uint64_t now = lvgl_port_get_time_us();
+    frame_render_us += (uint32_t)(now - render_mark_us);
+    while (flush_pending > 0) {
+        lvgl_flush_done_wait();
+    }
+    render_mark_us = lvgl_port_get_time_us();
+#endif
+}
+
+static void lvgl_port_flush_submit(lvgl_port_disp_t *disp, M5GFX *gfx, const lv_area_t *area, void *px_map,
+                                   int32_t stride, bool last, bool ready)
+{
+    uint64_t now = lvgl_port_get_time_us();
+    frame_render_us += (uint32_t)(now - render_mark_us);
+
+    lvgl_flush_job_t job;
+    job.disp           = disp;
+    job.gfx            = gfx;
+    job.area           = *area;
+    job.px_map         = px_map;
+    job.stride         = stride;
+    job.last           = last;
+    job.ready          = ready;
+    job.probe          = false;
+    job.render_us      = frame_render_us;
+    job.frame_start_us = frame_start_us;
+
+    if (probe_armed && probe.read_us != 0) {
+        if (probe.flush_us == 0 && area->x1 <= probe_area.x2 && area->x2 >= probe_area.x1 &&
+            area->y1 <= probe_area.y2 && area->y2 >= probe_area.y1) {
+            probe.render_us = frame_start_us;
+            probe.flush_us  = now;
+        }
+        if (probe.flush_us != 0 && last) {
+            job.probe   = true;
+            probe_armed = false;
+        }
+    }
+
+#if LV_PORT_ASYNC_FLUSH
+    flush_pending++;
+    lvgl_flush_queue_push(&job);
+#else
+    lvgl_port_flush_job(&job);
+#endif
+    render_mark_us = lvgl_port_get_time_us();
+}
+
+static void lvgl_port_direct_add(const lv_area_t *area)
+{
+    if (direct_area_cnt < LVGL_DIRECT_AREA_MAX) {
+        direct_areas[direct_area_cnt++] = *area;
+    } else {
+        // Out of slots, grow the last one to cover the new area too
+        lv_area_t *a = &direct_areas[LVGL_DIRECT_AREA_MAX - 1];
+        a->x1        = LV_MIN(a->x1, area->x1);
+        a->y1        = LV_MIN(a->y1, area->y1);
+        a->x2        = LV_MAX(a->x2, area->x2);
+        a->y2        = LV_MAX(a->y2, area->y2);
+    }
+}
+
+// Sends every dirty area of the frame from the full screen framebuffer in one transaction
+static void lvgl_port_direct_present(lvgl_port_disp_t *disp, M5GFX *gfx, void *fb, int32_t stride)
+{
+    if (direct_area_cnt == 0) {
+        lvgl_port_flush_ready(disp);
+        return;
+    }
+    for (uint32_t i = 0; i < direct_area_cnt; i++) {
+        const lv_area_t *a = &direct_areas[i];
+        uint16_t *px       = (uint16_t *)fb + a->y1 * stride + a->x1;
+        bool last          = (i == direct_area_cnt - 1);
+        lvgl_port_flush_submit(disp, gfx, a, px, stride, last, last);
+    }
+    direct_area_cnt = 0;
+}
+
+static void *lvgl_port_alloc_buffer(size_t size)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#if defined(BOARD_HAS_PSRAM)
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#else
+    return malloc(size);
+#endif
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    const size_t alignment    = 64;
+    const size_t aligned_size = (size + alignment - 1) & ~(alignment - 1);
+    void *buf                 = aligned_alloc(alignment, aligned_size);
+    if (buf) {
+        memset(buf, 0, aligned_size);
+    }
+    return buf;
+#endif
+}
+
+// Two full screen framebuffers for direct and full render modes and the conversion buffer of direct mode,
+// falls back to partial mode without enough RAM
+static bool lvgl_port_alloc_framebuffers(int32_t width, int32_t height, size_t px_size, void **fb1, void **fb2)
+{
+    if (render_mode == LVGL_PORT_RENDER_PARTIAL) {
+        return false;
+    }
+    const size_t size = (size_t)width * height * px_size;
+    *fb1              = lvgl_port_alloc_buffer(size);
+    *fb2              = lvgl_port_alloc_buffer(size);
+    if (render_mode == LVGL_PORT_RENDER_DIRECT) {
+#if LV_PORT_DIRECT_FLUSH
+        direct_buf = (uint16_t *)lvgl_port_alloc_buffer((size_t)width * height * sizeof(uint16_t));
+#else
+        direct_buf = (uint16_t *)malloc((size_t)width * sizeof(uint16_t));  // internal RAM where there is PSRAM
+#endif
+    }
+    if (*fb1 && *fb2 && (direct_buf || render_mode != LVGL_PORT_RENDER_DIRECT)) {
+        return true;
+    }
+    printf("WARNING: Not enough memory for two %u byte framebuffers, using partial render mode\n", (unsigned)size);
+    free(*fb1);
+    free(*fb2);
+    free(direct_buf);
+    direct_buf  = NULL;
+    render_mode = LVGL_PORT_RENDER_PARTIAL;
+    return false;
+}
+
+// Takes the resolution from the panel, M5GFX sizes Panel_sdl for the board without opening a window
+static bool lvgl_port_headless_init(M5GFX &gfx)
+{
+    if (!headless) {
+        return true;
+    }
+    headless_w  = gfx.width();
+    headless_h  = gfx.height();
+    headless_fb = (uint16_t *)lvgl_port_alloc_buffer(headless_w * headless_h * sizeof(uint16_t));
+    if (headless_fb == NULL) {
+        printf("ERROR: Failed to allocate the %dx%d headless framebuffer\n", (int)headless_w, (int)headless_h);
+        return false;
+    }
+    return true;
+}
+
+// Draw buffers of partial render mode: `lines` rows of the screen width each, one or two of them
+typedef struct {
+    int32_t lines;
+    bool two;
+} lvgl_buffer_config_t;
+
+static size_t lvgl_port_buffer_bytes(int32_t width, int32_t lines, size_t px_size)
+{
+    // Rounded up so a second buffer placed right behind the first one stays aligned
+    return ((size_t)width * lines * px_size + 63) & ~(size_t)63;
+}
+
+static lvgl_buffer_config_t lvgl_port_default_buffers(void)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && !defined(BOARD_HAS_PSRAM)
+    return {LV_BUFFER_LINE, false};  // internal RAM only, keep one buffer
+#else
+    return {LV_BUFFER_LINE, true};
+#endif
+}
+
+static bool lvgl_port_alloc_draw_buffers(int32_t width, size_t px_size, lvgl_buffer_config_t cfg, void **buf1,
+                                         void **buf2)
+{
+    const size_t size = lvgl_port_buffer_bytes(width, cfg.lines, px_size);
+    *buf1             = lvgl_port_alloc_buffer(size);
+    *buf2             = cfg.two ? lvgl_port_alloc_buffer(size) : NULL;
+    if (*buf1 && (*buf2 || !cfg.two)) {
+        return true;
+    }
+    printf("ERROR: Failed to allocate %u byte draw buffers\n", (unsigned)size);
+    free(*buf1);
+    free(*buf2);
+    return false;
+}
+
+// Version specific, defined with the display driver below
+static void lvgl_port_set_draw_buffers(lvgl_port_disp_t *disp, void *buf1, void *buf2, size_t size);
+
+#if LV_PORT_BUFFER_AUTOTUNE
+#define LVGL_AUTOTUNE_FRAMES 3  // per candidate, after one warm up frame
+
+// A screenful of what the stripes get rendered for in practice: gradients, rounded corners, shadows and text
+static lv_obj_t *lvgl_port_calibration_scene(int32_t width, int32_t height)
+{
+#if LVGL_USE_V8 == 1
+    lv_obj_t *scene = lv_obj_create(lv_scr_act());
+#else
+    lv_obj_t *scene = lv_obj_create(lv_screen_active());
+#endif
+    lv_obj_remove_style_all(scene);
+    lv_obj_set_size(scene, width, height);
+    lv_obj_set_style_bg_opa(scene, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(scene, lv_palette_main(LV_PALETTE_BLUE), 0);
+    lv_obj_set_style_bg_grad_color(scene, lv_palette_main(LV_PALETTE_PURPLE), 0);
+    lv_obj_set_style_bg_grad_dir(scene, LV_GRAD_DIR_VER, 0);
+
+    const int32_t cols = 3, rows = 4;
+    for (int32_t i = 0; i < cols * rows; i++) {
+        lv_obj_t *card = lv_obj_create(scene);
+        lv_obj_set_pos(card, (i % cols) * width / cols + 4, (i / cols) * height / rows + 4);
+        lv_obj_set_size(card, width / cols - 8, height / rows - 8);
+        lv_obj_set_style_radius(card, 8, 0);
+        lv_obj_set_style_shadow_width(card, 12, 0);
+        lv_obj_t *label = lv_label_create(card);
+        lv_label_set_text(label, "Ag 42");
+        lv_obj_center(label);
+    }
+    return scene;
+}
+
+// Average time to render and flush the whole scene [us]
+static uint32_t lvgl_port_calibration_run(lv_obj_t *scene, uint32_t frames)
+{
+    lv_obj_invalidate(scene);
+    lv_refr_now(NULL);  // warm up
+    lvgl_port_flush_wait();
+
+    uint64_t t0 = lvgl_port_get_time_us();
+    for (uint32_t i = 0; i < frames; i++) {
+        lv_obj_invalidate(scene);
+        lv_refr_now(NULL);
+    }
+    lvgl_port_flush_wait();
+    return (uint32_t)((lvgl_port_get_time_us() - t0) / frames);
+}
+
+// Renders a calibration scene with every stripe height and buffer count that fits the budget, then leaves
+// the fastest configuration installed. Within 3% of the fastest the smaller one wins.
+static bool lvgl_port_autotune_buffers(lvgl_port_disp_t *disp, int32_t width, int32_t height, size_t px_size)
+{
+    static const int32_t candidate_lines[] = {10, 20, 30, 40, 60, 80, 120, 160, 240, 320, 480, 640, 960, 1280};
+    const size_t n_lines                   = sizeof(candidate_lines) / sizeof(candidate_lines[0]);
+
+    lvgl_buffer_config_t def = lvgl_port_default_buffers();
+    size_t budget            = LV_PORT_BUFFER_BUDGET;
+    if (budget == 0) {
+        budget = lvgl_port_buffer_bytes(width, def.lines, px_size) * (def.two ? 2 : 1);
+    }
+
+    // Candidates sorted by the memory they take
+    lvgl_buffer_config_t cand[2 * n_lines];
+    size_t cand_bytes[2 * n_lines];
+    uint32_t n_cand = 0;
+    for (size_t i = 0; i < n_lines; i++) {
+        const int32_t lines = candidate_lines[i] < height ? candidate_lines[i] : height;
+        for (int two = 0; two < 2; two++) {
+            const size_t bytes = lvgl_port_buffer_bytes(width, lines, px_size) * (two ? 2 : 1);
+            if (bytes > budget) {
+                continue;
+            }
+            uint32_t j = n_cand++;
+            for (; j > 0 && cand_bytes[j - 1] > bytes; j--) {
+                cand[j]       = cand[j - 1];
+                cand_bytes[j] = cand_bytes[j - 1];
+            }
+            cand[j]       = {lines, two != 0};
+            cand_bytes[j] = bytes;
+        }
+        if (candidate_lines[i] >= height) {
+            break;
+        }
+    }
+    if (n_cand == 0) {
+        printf("WARNING: Buffer budget of %u bytes is below %d lines, autotune skipped\n", (unsigned)budget,
+               (int)candidate_lines[0]);
+        return false;
+    }
+
+    uint8_t *block = (uint8_t *)lvgl_port_alloc_buffer(cand_bytes[n_cand - 1]);
+    if (block == NULL) {
+        printf("WARNING: No memory for the %u byte buffer budget, autotune skipped\n", (unsigned)cand_bytes[n_cand - 1]);
+        return false;
+    }
+
+    lv_obj_t *scene = lvgl_port_calibration_scene(width, height);
+    uint32_t best = 0, best_us = UINT32_MAX;
+    for (uint32_t i = 0; i < n_cand; i++) {
+        const size_t size = lvgl_port_buffer_bytes(width, cand[i].lines, px_size);
+        lvgl_port_set_draw_buffers(disp, block, cand[i].two ? block + size : NULL, size);
+        uint32_t us = lvgl_port_calibration_run(scene, LVGL_AUTOTUNE_FRAMES);
+#if LV_PORT_FRAME_LOG
+        printf("autotune: %d lines x%d, %u bytes: %u us/frame\n", (int)cand[i].lines, cand[i].two ? 2 : 1,
+               (unsigned)cand_bytes[i], (unsigned)us);
+#endif
+        if ((uint64_t)us * 100 < (uint64_t)best_us * 97) {
+            best    = i;
+            best_us = us;
+        }
+    }
+#if LVGL_USE_V8 == 1
+    lv_obj_del(scene);
+#else
+    lv_obj_delete(scene);
+#endif
+
+    // Swap the calibration block for exactly sized buffers
+    void *buf1, *buf2;
+    if (lvgl_port_alloc_draw_buffers(width, px_size, cand[best], &buf1, &buf2)) {
+        lvgl_port_set_draw_buffers(disp, buf1, buf2, lvgl_port_buffer_bytes(width, cand[best].lines, px_size));
+        free(block);
+    } else {
+        // Keep running from the block
+        const size_t size = lvgl_port_buffer_bytes(width, cand[best].lines, px_size);
+        lvgl_port_set_draw_buffers(disp, block, cand[best].two ? block + size : NULL, size);
+    }
+    printf("Draw buffers: %d lines x%d (%u of %u bytes), %u us/frame\n", (int)cand[best].lines,
+           cand[best].two ? 2 : 1, (unsigned)cand_bytes[best], (unsigned)budget, (unsigned)best_us);
+    return true;
+}
+#endif
+
+// Draw buffers of partial render mode, the display must exist already
+static bool lvgl_port_setup_draw_buffers(lvgl_port_disp_t *disp, int32_t width, int32_t height, size_t px_size)
+{
+#if LV_PORT_BUFFER_AUTOTUNE
+    if (lvgl_port_autotune_buffers(disp, width, height, px_size)) {
+        return true;
+    }
+#endif
+    lvgl_buffer_config_t cfg = lvgl_port_default_buffers();
+    if (cfg.lines > height) {
+        cfg.lines = height;
+    }
+    void *buf1, *buf2;
+    if (!lvgl_port_alloc_draw_buffers(width, px_size, cfg, &buf1, &buf2)) {
+        return false;
+    }
+    lvgl_port_set_draw_buffers(disp, buf1, buf2, lvgl_port_buffer_bytes(width, cfg.lines, px_size));
+    return true;
+}
+
+#if LV_PORT_INPUT_QUEUE
+// Input queue: while the panel is touched a sampler thread reads it every LV_PORT_TOUCH_SAMPLE_MS and queues each
+// change with its time, so points between two indev reads are not lost. Touch down and up wake the GUI thread
+// for an immediate read. Untouched, the sampler sleeps until the touch interrupt (device) or an SDL event,
+// boards without a touch interrupt pin are polled every LVGL_TOUCH_IDLE_POLL_MS.
+#define LVGL_INPUT_QUEUE_LEN 64        // power of two
+#define LVGL_TOUCH_IDLE_POLL_MS 30     // the default indev read period
+#define LVGL_TOUCH_KICK_SAMPLE_MS 100  // keep sampling this long after a kick, Panel_sdl may not have the event yet
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    bool pressed;
+    uint32_t tick;  // lv_tick_get() when sampled
+} lvgl_input_sample_t;
+
+// Single producer (the sampler), single consumer (the GUI thread)
+static lvgl_input_sample_t input_queue[LVGL_INPUT_QUEUE_LEN];
+static std::atomic<uint32_t> input_head;
+static std::atomic<uint32_t> input_tail;
+static M5GFX *input_gfx;
+static bool input_irq;  // the sampler is woken by the touch interrupt
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static TaskHandle_t xInputTask;
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static SDL_sem *xInputWake;
+#endif
+
+static bool lvgl_input_push(const lvgl_input_sample_t *sample)
+{
+    uint32_t tail = input_tail.load(std::memory_order_relaxed);
+    if (tail - input_head.load(std::memory_order_acquire) == LVGL_INPUT_QUEUE_LEN) {
+        return false;  // the GUI thread is stalled, drop the sample
+    }
+    input_queue[tail % LVGL_INPUT_QUEUE_LEN] = *sample;
+    input_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+static bool lvgl_input_pop(lvgl_input_sample_t *sample)
+{
+    uint32_t head = input_head.load(std::memory_order_relaxed);
+    if (head == input_tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    *sample = input_queue[head % LVGL_INPUT_QUEUE_LEN];
+    input_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+static bool lvgl_input_pending(void)
+{
+    return input_head.load(std::memory_order_relaxed) != input_tail.load(std::memory_order_acquire);
+}
+
+// Reads the panel once and queues the sample when it changed, returns whether the panel is touched
+static bool lvgl_input_sample(void)
+{
+    static lvgl_input_sample_t last;
+    uint16_t x, y;
+    lvgl_input_sample_t sample = last;
+
+    touch_mutex.lock();
+    sample.pressed = input_gfx->getTouch(&x, &y);
+    touch_mutex.unlock();
+    if (sample.pressed) {
+        sample.x = x;
+        sample.y = y;
+    }
+    if (sample.pressed == last.pressed && (sample.x == last.x && sample.y == last.y)) {
+        return sample.pressed;
+    }
+    sample.tick = lvgl_port_tick_get();
+    lvgl_input_push(&sample);
+    if (sample.pressed != last.pressed) {
+        input_event = true;
+        lvgl_port_wake();
+    }
+    last = sample;
+    return sample.pressed;
+}
+
+// Sleeps for ms (LV_NO_TIMER_READY: no limit), returns true when woken early by a kick
+static bool lvgl_input_sleep(uint32_t ms)
 {
-    (void)arg;
-    lv_tick_inc(10);
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    return ulTaskNotifyTake(pdTRUE, (ms == LV_NO_TIMER_READY) ? portMAX_DELAY : LV_MAX(pdMS_TO_TICKS(ms), 1)) > 0;
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    if (ms == LV_NO_TIMER_READY) {
+        return SDL_SemWait(xInputWake) == 0;
+    }
+    return SDL_SemWaitTimeout(xInputWake, ms) == 0;
+#endif
 }
-static void lvgl_rtos_task(void *pvParameter)
+
+static void lvgl_input_loop(void)
 {
-    (void)pvParameter;
+    uint32_t kick_ms = (uint32_t)(lvgl_port_get_time_us() / 1000) - LVGL_TOUCH_KICK_SAMPLE_MS;  // last kick
     while (1) {
-        if (pdTRUE == xSemaphoreTake(xGuiSemaphore, portMAX_DELAY)) {
-            lv_timer_handler();
-#ifdef USE_EEZ_STUDIO
-            ui_tick();
-#endif
-            xSemaphoreGive(xGuiSemaphore);
+        const uint32_t now_ms = (uint32_t)(lvgl_port_get_time_us() / 1000);
+        if (lvgl_input_sample() || now_ms - kick_ms < LVGL_TOUCH_KICK_SAMPLE_MS) {
+            lvgl_input_sleep(LV_PORT_TOUCH_SAMPLE_MS);
+            continue;
+        }
+        if (lvgl_input_sleep(input_irq ? LV_NO_TIMER_READY : LVGL_TOUCH_IDLE_POLL_MS)) {
+            kick_ms = (uint32_t)(lvgl_port_get_time_us() / 1000);
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static void IRAM_ATTR lvgl_touch_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(xInputTask, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void lvgl_input_task(void *pvParameter)
+{
+    (void)pvParameter;
+    lvgl_input_loop();
+}
 #elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-static uint32_t lvgl_tick_timer(uint32_t interval, void *param)
+static void lvgl_input_kick(void)
 {
-    (void)interval;
-    (void)param;
-    lv_tick_inc(10);
-    return 10;
+    if (xInputWake && SDL_SemValue(xInputWake) == 0) {
+        SDL_SemPost(xInputWake);
+    }
 }
 
-static int lvgl_sdl_thread(void *data)
+static int lvgl_input_thread(void *data)
 {
     (void)data;
-    while (1) {
-        if (SDL_LockMutex(xGuiMutex) == 0) {
-            lv_timer_handler();
-            SDL_UnlockMutex(xGuiMutex);
-        }
-        SDL_Delay(10);
-    }
+    lvgl_input_loop();
     return 0;
 }
 #endif
 
-#if LVGL_USE_V8 == 1
-static lv_disp_draw_buf_t draw_buf;
-static void lvgl_flush_cb(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+static void lvgl_input_start(M5GFX &gfx)
 {
-    M5GFX &gfx      = *(M5GFX *)disp->user_data;
-    int w           = (area->x2 - area->x1 + 1);
-    int h           = (area->y2 - area->y1 + 1);
-    uint32_t pixels = w * h;
-
-    gfx.startWrite();
-    gfx.setAddrWindow(area->x1, area->y1, w, h);
-
-    // Critical fix: Use safe pixel writing method to avoid M5GFX SIMD optimizations
-    // Break large transfers into small chunks to avoid problematic copy_rgb_fast function
-    const uint32_t SAFE_CHUNK_SIZE = 8192;  // 8K pixels per chunk, suitable for small buffer settings
+    input_gfx = &gfx;
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    int pin_int = gfx.touch()->config().pin_int;
+    xTaskCreate(lvgl_input_task, "lvgl_input_task", 3072, NULL, 2, &xInputTask);
+    if (pin_int >= 0) {
+        input_irq = true;
+        attachInterrupt(pin_int, lvgl_touch_isr, FALLING);
+    }
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    input_irq  = true;  // the SDL event watch kicks the sampler
+    xInputWake = SDL_CreateSemaphore(0);
+    SDL_CreateThread(lvgl_input_thread, "lvgl_input_thread", NULL);
+#endif
+}
+#endif
 
-    if (pixels > SAFE_CHUNK_SIZE) {
-        // Chunked transmission for large data
-        const lgfx::rgb565_t *src = (const lgfx::rgb565_t *)color_p;
-        uint32_t remaining        = pixels;
-        uint32_t offset           = 0;
+static bool touch_pressed;  // last state handed to LVGL
 
-        while (remaining > 0) {
-            uint32_t chunk_size = (remaining > SAFE_CHUNK_SIZE) ? SAFE_CHUNK_SIZE : remaining;
-            gfx.writePixels(src + offset, chunk_size);
-            offset += chunk_size;
-            remaining -= chunk_size;
+// Fills data from the input queue, one sample per call, or straight from the panel without the queue
+static void lvgl_port_read_touch(M5GFX &gfx, lv_indev_data_t *data)
+{
+    static lv_point_t panel_point;  // the last state stays until the next change
+    static bool panel_touched;
+    uint32_t tick = lv_tick_get();
+#if LV_PORT_INPUT_QUEUE
+    lvgl_input_sample_t sample;
+    (void)gfx;
+    if (lvgl_input_pop(&sample)) {
+        panel_point.x = sample.x;
+        panel_point.y = sample.y;
+        panel_touched = sample.pressed;
+        tick          = sample.tick;
+        if (probe_armed && probe.read_us == 0) {
+            probe.read_us = lvgl_port_get_time_us();
         }
+    }
+    data->continue_reading = lvgl_input_pending();
+#else
+    uint16_t touchX, touchY;
+    touch_mutex.lock();
+    panel_touched = gfx.getTouch(&touchX, &touchY);
+    touch_mutex.unlock();
+    if (panel_touched) {
+        panel_point.x = touchX;
+        panel_point.y = touchY;
+    }
+#endif
+
+    lv_point_t point = panel_point;
+    bool touched     = panel_touched;
+    if (lvgl_port_replay_active()) {
+        // A replayed session stands in for the panel
+        data->continue_reading = lvgl_port_replay_read(lv_tick_get(), &point, &touched, &tick);
+    } else {
+        lvgl_port_record_sample(tick, &point, touched);
+    }
+#if LVGL_USE_V9 == 1
+    data->timestamp = tick;
+#endif
+    touch_pressed = touched;
+    if (!touched) {
+        data->state = LV_INDEV_STATE_REL;
     } else {
-        // Direct transmission for small data
-        gfx.writePixels((lgfx::rgb565_t *)color_p, pixels);
+        data->state = LV_INDEV_STATE_PR;
+        data->point = point;
     }
+}
 
-    gfx.endWrite();
+// GUI thread scheduling: sleep until lv_timer_handler()'s next deadline, park when nothing is going on
+#define LVGL_INPUT_GRACE_MS 100  // stay awake after pointer input, the panel may not have seen it yet
 
-    lv_disp_flush_ready(disp);
+static M5GFX *gui_gfx;
+static lv_indev_t *gui_indev;
+static bool gui_parked;
+static bool input_wakes;      // input wakes the GUI thread, so the touch need not be polled while parked
+static bool gui_invalidated;  // v9 only, v8 keeps the count in the display
+static uint32_t input_tick;   // lv_tick_get() of the last input event
+static uint32_t refr_period;
+
+static lv_timer_t *lvgl_port_refr_timer(void)
+{
+#if LVGL_USE_V8 == 1
+    return _lv_disp_get_refr_timer(lv_disp_get_default());
+#else
+    return lv_display_get_refr_timer(lv_display_get_default());
+#endif
 }
 
-static void lvgl_read_cb(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+static bool lvgl_port_invalidated(void)
 {
-    M5GFX &gfx = *(M5GFX *)indev_driver->user_data;
-    uint16_t touchX, touchY;
+#if LVGL_USE_V8 == 1
+    return lv_disp_get_default()->inv_p != 0;
+#else
+    return gui_invalidated;
+#endif
+}
 
-    bool touched = gfx.getTouch(&touchX, &touchY);
-    if (!touched) {
-        data->state = LV_INDEV_STATE_REL;
-    } else {
-        data->state   = LV_INDEV_STATE_PR;
-        data->point.x = touchX;
-        data->point.y = touchY;
+// Time until the next unpaused timer is due [ms], without running the due ones as lv_timer_handler() would
+static uint32_t lvgl_timer_deadline(void)
+{
+#if LVGL_USE_V8 == 1
+    uint32_t next = LV_NO_TIMER_READY;
+    for (lv_timer_t *t = lv_timer_get_next(NULL); t != NULL; t = lv_timer_get_next(t)) {
+        if (!t->paused) {
+            const uint32_t elapsed = lv_tick_elaps(t->last_run);
+            next                   = LV_MIN(next, elapsed >= t->period ? 0 : t->period - elapsed);
+        }
     }
+    return next;
+#else
+    // As of the lv_timer_handler() just run, the paused refresh timer may wake the thread once more
+    return lv_timer_get_time_until_next();
+#endif
 }
 
-void lvgl_port_init(M5GFX &gfx)
+// One round of the GUI thread with the GUI lock held, returns how long it may sleep [ms]
+// or LV_NO_TIMER_READY to sleep until lvgl_port_wake()
+static uint32_t lvgl_port_gui_step(void)
 {
-    lv_init();
+    lv_timer_t *refr_timer = lvgl_port_refr_timer();
+    lv_timer_t *read_timer = lv_indev_get_read_timer(gui_indev);
+
+    if (gui_parked) {
+        // Woken up, the app may have changed anything while holding the lock
+        lv_timer_resume(refr_timer);
+        lv_timer_resume(read_timer);
+        gui_parked = false;
+    }
+    if (input_event.exchange(false)) {
+        input_tick = lv_tick_get();
+        lv_timer_ready(read_timer);
+    }
+
+#if LV_PORT_VIRTUAL_CLOCK
+    virtual_ms.fetch_add(virtual_step, std::memory_order_relaxed);
+    virtual_step = 0;
+#endif
+
+    // Replayed samples are due on LVGL ticks, read them on time even while parked
+    const uint32_t replay_ms = lvgl_port_replay_step(lv_tick_get());
+    if (replay_ms == 0) {
+        input_tick = lv_tick_get();
+        lv_timer_ready(read_timer);
+    }
 
+    // Closures posted by other threads, a flood of them must not starve rendering
+    const uint64_t post_start = lvgl_port_get_time_us();
+    while (lvgl_port_post_run_one() && lvgl_port_get_time_us() - post_start < LV_PORT_POST_BUDGET_US) {
+    }
+
+#if LV_PORT_STATS
+    uint64_t t0 = lvgl_port_get_time_us();
+#endif
+    uint32_t sleep_ms = lv_timer_handler();
+#if LV_PORT_STATS
+    lvgl_port_stats_record(LVGL_PORT_STAT_TIMER_HANDLER_US, (uint32_t)(lvgl_port_get_time_us() - t0));
+#endif
+    lvgl_port_heap_step(lv_tick_get());
+    lvgl_port_cache_step(lv_tick_get());
+
+    // Refresh rate governor
+    const bool active     = touch_pressed || lv_anim_count_running() > 0;
+    const uint32_t period = active ? LV_PORT_REFR_PERIOD_ACTIVE : LV_PORT_REFR_PERIOD_IDLE;
+    if (period != refr_period) {
+        lv_timer_set_period(refr_timer, period);
+        refr_period = period;
+    }
+
+    if (!active && !lvgl_port_invalidated() && lv_tick_elaps(input_tick) > LVGL_INPUT_GRACE_MS) {
+        // Nothing to redraw until something invalidates an area, which resumes the refresh timer again
+        lv_timer_pause(refr_timer);
+        if (input_wakes) {
+            lv_timer_pause(read_timer);
+        }
+        gui_parked = true;
+        sleep_ms   = lvgl_timer_deadline();  // of the app's own timers, if any
+    }
+    if (lvgl_port_post_pending()) {
+        sleep_ms = 0;  // over budget, continue after this frame
+    }
+    sleep_ms = LV_MIN(sleep_ms, replay_ms);
+#if LV_PORT_VIRTUAL_CLOCK
+    if (sleep_ms != LV_NO_TIMER_READY) {
+        // Jump to the deadline on the next step instead of sleeping until it
+        virtual_step = sleep_ms;
+        sleep_ms     = 0;
+    }
+#endif
+    return sleep_ms;
+}
+
+static void lvgl_port_gui_start(M5GFX &gfx, lv_indev_t *indev)
+{
+    gui_gfx    = &gfx;
+    gui_indev  = indev;
+    input_tick = lv_tick_get();
+    lvgl_port_post_init();
+    lvgl_port_session_start();
+    lvgl_port_heap_start();
+    lvgl_port_fs_start();
+    lvgl_port_pack_start();
+    lvgl_port_cache_start();
+    lvgl_port_glyph_start();
 #if defined(ARDUINO) && defined(ESP_PLATFORM)
-#if defined(BOARD_HAS_PSRAM)
-    static lv_color_t *buf1 =
-        (lv_color_t *)heap_caps_malloc(gfx.width() * LV_BUFFER_LINE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-    static lv_color_t *buf2 =
-        (lv_color_t *)heap_caps_malloc(gfx.width() * LV_BUFFER_LINE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, gfx.width() * LV_BUFFER_LINE);
-#else
-    static lv_color_t *buf1 = (lv_color_t *)malloc(gfx.width() * LV_BUFFER_LINE * sizeof(lv_color_t));
-    lv_disp_draw_buf_init(&draw_buf, buf1, NULL, gfx.width() * LV_BUFFER_LINE);
+    // Touch panels are polled by the read timer unless the input queue samples them, no panel needs no polling
+    input_wakes = (gfx.touch() == nullptr) || LV_PORT_INPUT_QUEUE;
+
+    xGuiSemaphore = xSemaphoreCreateMutex();
+    xTaskCreate(lvgl_rtos_task, "lvgl_rtos_task", 4096, NULL, 1, &xGuiTask);
+#if LV_PORT_INPUT_QUEUE
+    if (gfx.touch()) {
+        lvgl_input_start(gfx);
+    }
 #endif
 #elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    const uint32_t buf_pixels = gfx.width() * LV_BUFFER_LINE;
-    // Moderate safety margin, combined with chunked transmission strategy, suitable for small buffers
-    const uint32_t extra_pixels = 1024;        // 1024 pixels safety margin (2KB)
-    const uint32_t safe_pixels  = buf_pixels;  // LVGL can use all allocated pixels
+#if !LV_PORT_INPUT_QUEUE
+    (void)gfx;
+#endif
+    input_wakes = true;
+
+    xGuiLock = SDL_CreateSemaphore(1);
+    xGuiWake = SDL_CreateSemaphore(0);
+    if (!headless) {
+#if LV_PORT_INPUT_QUEUE
+        lvgl_input_start(gfx);
+#endif
+        SDL_AddEventWatch(lvgl_sdl_event_watch, NULL);
+    }
+    SDL_CreateThread(lvgl_sdl_thread, "lvgl_sdl_thread", NULL);
+#endif
+}
+#endif
+
+#if LVGL_USE_V8 == 1
+static lv_disp_draw_buf_t draw_buf;
 
-    // Use aligned allocation to ensure memory boundary alignment, reducing SIMD access issues
-    const size_t alignment    = 64;  // 64-byte alignment
-    const size_t total_bytes  = (buf_pixels + extra_pixels) * sizeof(lv_color_t);
-    const size_t aligned_size = (total_bytes + alignment - 1) & ~(alignment - 1);
+static void lvgl_port_set_draw_buffers(lv_disp_drv_t *disp, void *buf1, void *buf2, size_t size)
+{
+    (void)disp;
+    lvgl_port_flush_wait();  // nothing may still be read from the old buffers
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, size / sizeof(lv_color_t));
+}
 
-    static lv_color_t *buf1 = static_cast<lv_color_t *>(aligned_alloc(alignment, aligned_size));
-    static lv_color_t *buf2 = static_cast<lv_color_t *>(aligned_alloc(alignment, aligned_size));
+static void lvgl_flush_cb(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+{
+    M5GFX *gfx = (M5GFX *)disp->user_data;
+    bool last  = lv_disp_flush_is_last(disp);
 
-    if (!buf1 || !buf2) {
-        printf("ERROR: Failed to allocate aligned memory buffers\n");
+    if (render_mode == LVGL_PORT_RENDER_DIRECT) {
+        if (!last) {
+            lv_disp_flush_ready(disp);
+            return;
+        }
+        // The flush area does not describe the dirty areas in v8 direct mode, take them from the display
+        lv_disp_t *d = _lv_refr_get_disp_refreshing();
+        for (uint32_t i = 0; i < d->inv_p; i++) {
+            if (!d->inv_area_joined[i]) {
+                lvgl_port_direct_add(&d->inv_areas[i]);
+            }
+        }
+        lvgl_port_direct_present(disp, gfx, color_p, disp->hor_res);
         return;
     }
 
-    // Clear buffers to avoid issues caused by random data
-    memset(buf1, 0, aligned_size);
-    memset(buf2, 0, aligned_size);
+    lvgl_port_flush_submit(disp, gfx, area, color_p, lv_area_get_width(area), last, true);
+}
+
+static void lvgl_render_start_cb(lv_disp_drv_t *disp)
+{
+    (void)disp;
+    lvgl_port_render_start();
+}
 
-    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, safe_pixels);
+#if LV_PORT_ASYNC_FLUSH
+static void lvgl_flush_wait_cb(lv_disp_drv_t *disp)
+{
+    (void)disp;
+    lvgl_port_flush_wait();
+}
 #endif
 
+static void lvgl_read_cb(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+{
+    lvgl_port_read_touch(*(M5GFX *)indev_driver->user_data, data);
+}
+
+void lvgl_port_init(M5GFX &gfx)
+{
+    lv_init();
+    if (!lvgl_port_headless_init(gfx)) {
+        return;
+    }
+
+    void *fb1, *fb2;
+    const uint32_t fb_pixels = gfx.width() * gfx.height();
+    const bool full_buffers  = lvgl_port_alloc_framebuffers(gfx.width(), gfx.height(), sizeof(lv_color_t), &fb1, &fb2);
+    if (full_buffers) {
+        lv_disp_draw_buf_init(&draw_buf, fb1, fb2, fb_pixels);
+    }
+
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
-    disp_drv.hor_res   = gfx.width();
-    disp_drv.ver_res   = gfx.height();
-    disp_drv.flush_cb  = lvgl_flush_cb;
-    disp_drv.draw_buf  = &draw_buf;
-    disp_drv.user_data = &gfx;
+    disp_drv.hor_res         = gfx.width();
+    disp_drv.ver_res         = gfx.height();
+    disp_drv.flush_cb        = lvgl_flush_cb;
+    disp_drv.draw_buf        = &draw_buf;
+    disp_drv.user_data       = &gfx;
+    disp_drv.render_start_cb = lvgl_render_start_cb;
+    disp_drv.direct_mode     = (render_mode == LVGL_PORT_RENDER_DIRECT);
+    disp_drv.full_refresh    = (render_mode == LVGL_PORT_RENDER_FULL);
+#if LV_PORT_ASYNC_FLUSH
+    disp_drv.wait_cb = lvgl_flush_wait_cb;
+    lvgl_port_flush_start();
+#endif
     lv_disp_drv_register(&disp_drv);
 
+    // Partial mode buffers come after registering, the autotuner renders through the display
+    if (!full_buffers && !lvgl_port_setup_draw_buffers(&disp_drv, gfx.width(), gfx.height(), sizeof(lv_color_t))) {
+        return;
+    }
+
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
     indev_drv.type      = LV_INDEV_TYPE_POINTER;
@@ -173,75 +1540,66 @@ void lvgl_port_init(M5GFX &gfx)
     indev_drv.user_data = &gfx;
     lv_indev_t *indev   = lv_indev_drv_register(&indev_drv);
 
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-    xGuiSemaphore                                     = xSemaphoreCreateMutex();
-    const esp_timer_create_args_t periodic_timer_args = {.callback = &lvgl_tick_timer, .name = "lvgl_tick_timer"};
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, 10 * 1000));
-    xTaskCreate(lvgl_rtos_task, "lvgl_rtos_task", 4096, NULL, 1, NULL);
-#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    xGuiMutex = SDL_CreateMutex();
-    SDL_AddTimer(10, lvgl_tick_timer, NULL);
-    SDL_CreateThread(lvgl_sdl_thread, "lvgl_sdl_thread", NULL);
-#endif
+    lvgl_port_gui_start(gfx, indev);
 }
 #elif LVGL_USE_V9 == 1
-static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+static void lvgl_port_set_draw_buffers(lv_display_t *disp, void *buf1, void *buf2, size_t size)
 {
-    M5GFX &gfx = *(M5GFX *)lv_display_get_driver_data(disp);
-
-    uint32_t w      = (area->x2 - area->x1 + 1);
-    uint32_t h      = (area->y2 - area->y1 + 1);
-    uint32_t pixels = w * h;
-
-    gfx.startWrite();
-    gfx.setAddrWindow(area->x1, area->y1, w, h);
-
-    // Critical fix: Use safe pixel writing method to avoid M5GFX SIMD optimizations
-    // Break large transfers into small chunks to avoid problematic copy_rgb_fast function
-    const uint32_t SAFE_CHUNK_SIZE = 8192;  // 8K pixels per chunk, suitable for small buffer settings
+    lvgl_port_flush_wait();  // nothing may still be read from the old buffers
+    lv_display_set_buffers(disp, buf1, buf2, size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+}
 
-    if (pixels > SAFE_CHUNK_SIZE) {
-        // Chunked transmission for large data
-        const lgfx::rgb565_t *src = (const lgfx::rgb565_t *)px_map;
-        uint32_t remaining        = pixels;
-        uint32_t offset           = 0;
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    M5GFX *gfx = (M5GFX *)lv_display_get_driver_data(disp);
+    bool last  = lv_display_flush_is_last(disp);
 
-        while (remaining > 0) {
-            uint32_t chunk_size = (remaining > SAFE_CHUNK_SIZE) ? SAFE_CHUNK_SIZE : remaining;
-            gfx.writePixels(src + offset, chunk_size);
-            offset += chunk_size;
-            remaining -= chunk_size;
+    if (render_mode == LVGL_PORT_RENDER_DIRECT) {
+        // px_map is the whole framebuffer, LVGL itself copies the dirty areas to the other buffer
+        lvgl_port_direct_add(area);
+        if (last) {
+            lvgl_port_direct_present(disp, gfx, px_map, lv_display_get_horizontal_resolution(disp));
+        } else {
+            lv_display_flush_ready(disp);
         }
-    } else {
-        // Direct transmission for small data
-        gfx.writePixels((lgfx::rgb565_t *)px_map, pixels);
+        return;
     }
 
-    gfx.endWrite();
+    lvgl_port_flush_submit(disp, gfx, area, px_map, lv_area_get_width(area), last, true);
+}
 
-    lv_display_flush_ready(disp);
+static void lvgl_render_start_cb(lv_event_t *e)
+{
+    (void)e;
+    lvgl_port_render_start();
 }
 
-static void lvgl_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+// Tracks whether the display has areas waiting for a refresh
+static void lvgl_invalidate_cb(lv_event_t *e)
 {
-    M5GFX &gfx = *(M5GFX *)lv_indev_get_driver_data(indev);
-    uint16_t touchX, touchY;
+    gui_invalidated = (lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA);
+}
 
-    bool touched = gfx.getTouch(&touchX, &touchY);
-    if (!touched) {
-        data->state = LV_INDEV_STATE_REL;
-    } else {
-        data->state   = LV_INDEV_STATE_PR;
-        data->point.x = touchX;
-        data->point.y = touchY;
-    }
+#if LV_PORT_ASYNC_FLUSH
+static void lvgl_flush_wait_cb(lv_display_t *disp)
+{
+    (void)disp;
+    lvgl_port_flush_wait();
+}
+#endif
+
+static void lvgl_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    lvgl_port_read_touch(*(M5GFX *)lv_indev_get_driver_data(indev), data);
 }
 
 void lvgl_port_init(M5GFX &gfx)
 {
     lv_init();
+    lv_tick_set_cb(lvgl_port_tick_get);
+    if (!lvgl_port_headless_init(gfx)) {
+        return;
+    }
 
     static lv_display_t *disp = lv_display_create(gfx.width(), gfx.height());
     if (disp == NULL) {
@@ -251,42 +1609,25 @@ void lvgl_port_init(M5GFX &gfx)
 
     lv_display_set_driver_data(disp, &gfx);
     lv_display_set_flush_cb(disp, lvgl_flush_cb);
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-#if defined(BOARD_HAS_PSRAM)
-    static uint8_t *buf1 = (uint8_t *)heap_caps_malloc(gfx.width() * LV_BUFFER_LINE, MALLOC_CAP_SPIRAM);
-    static uint8_t *buf2 = (uint8_t *)heap_caps_malloc(gfx.width() * LV_BUFFER_LINE, MALLOC_CAP_SPIRAM);
-    lv_display_set_buffers(disp, (void *)buf1, (void *)buf2, gfx.width() * LV_BUFFER_LINE,
-                           LV_DISPLAY_RENDER_MODE_PARTIAL);
-#else
-    static uint8_t *buf1 = (uint8_t *)malloc(gfx.width() * LV_BUFFER_LINE);
-    lv_display_set_buffers(disp, (void *)buf1, NULL, gfx.width() * LV_BUFFER_LINE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_add_event_cb(disp, lvgl_render_start_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, lvgl_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, lvgl_invalidate_cb, LV_EVENT_REFR_READY, NULL);
+#if LV_PORT_ASYNC_FLUSH
+    lv_display_set_flush_wait_cb(disp, lvgl_flush_wait_cb);
+    lvgl_port_flush_start();
 #endif
-#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    const uint32_t buf_pixels = gfx.width() * LV_BUFFER_LINE;
-    const uint32_t buf_bytes  = buf_pixels * 2;  // LVGL v9 uses bytes (2 bytes per pixel for RGB565)
-    // Moderate safety margin, combined with chunked transmission strategy, suitable for small buffers
-    const uint32_t extra_bytes = 1024 * 2;  // 1024 pixels safety margin (2KB)
-
-    // Use aligned allocation to ensure memory boundary alignment, reducing SIMD access issues
-    const size_t alignment    = 64;  // 64-byte alignment
-    const size_t total_bytes  = buf_bytes + extra_bytes;
-    const size_t aligned_size = (total_bytes + alignment - 1) & ~(alignment - 1);
-
-    static uint8_t *buf1 = static_cast<uint8_t *>(aligned_alloc(alignment, aligned_size));
-    static uint8_t *buf2 = static_cast<uint8_t *>(aligned_alloc(alignment, aligned_size));
 
-    if (!buf1 || !buf2) {
-        printf("ERROR: Failed to allocate aligned memory buffers\n");
+    void *fb1, *fb2;
+    const uint32_t px_size  = lv_color_format_get_size(lv_display_get_color_format(disp));
+    const uint32_t fb_bytes = gfx.width() * gfx.height() * px_size;
+    if (lvgl_port_alloc_framebuffers(gfx.width(), gfx.height(), px_size, &fb1, &fb2)) {
+        lv_display_set_buffers(disp, fb1, fb2, fb_bytes,
+                               render_mode == LVGL_PORT_RENDER_DIRECT ? LV_DISPLAY_RENDER_MODE_DIRECT
+                                                                      : LV_DISPLAY_RENDER_MODE_FULL);
+    } else if (!lvgl_port_setup_draw_buffers(disp, gfx.width(), gfx.height(), px_size)) {
         return;
     }
 
-    // Clear buffers to avoid issues caused by random data
-    memset(buf1, 0, aligned_size);
-    memset(buf2, 0, aligned_size);
-
-    lv_display_set_buffers(disp, (void *)buf1, (void *)buf2, buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
-#endif
-
     static lv_indev_t *indev = lv_indev_create();
     LV_ASSERT_MALLOC(indev);
     if (indev == NULL) {
@@ -298,37 +1639,186 @@ void lvgl_port_init(M5GFX &gfx)
     lv_indev_set_read_cb(indev, lvgl_read_cb);
     lv_indev_set_display(indev, disp);
 
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-    xGuiSemaphore                                     = xSemaphoreCreateMutex();
-    const esp_timer_create_args_t periodic_timer_args = {.callback = &lvgl_tick_timer, .name = "lvgl_tick_timer"};
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, 10 * 1000));
-    xTaskCreate(lvgl_rtos_task, "lvgl_rtos_task", 4096, NULL, 1, NULL);
-#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    xGuiMutex = SDL_CreateMutex();
-    SDL_AddTimer(10, lvgl_tick_timer, NULL);
-    SDL_CreateThread(lvgl_sdl_thread, "lvgl_sdl_thread", NULL);
+    lvgl_port_gui_start(gfx, indev);
+}
 #endif
+
+void lvgl_port_set_render_mode(lvgl_port_render_mode_t mode)
+{
+    render_mode = mode;
+}
+
+void lvgl_port_get_frame_info(lvgl_port_frame_info_t *info)
+{
+    uint32_t seq;
+    do {
+        while ((seq = frame_info_seq.load(std::memory_order_acquire)) & 1) {
+        }
+        *info = frame_info;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (frame_info_seq.load(std::memory_order_relaxed) != seq);
+}
+
+void lvgl_port_refresh_now(void)
+{
+    lv_refr_now(NULL);
+    lvgl_port_flush_wait();
 }
+
+void lvgl_port_set_headless(bool enable)
+{
+    headless = enable;
+}
+
+bool lvgl_port_is_headless(void)
+{
+    return headless;
+}
+
+const uint16_t *lvgl_port_get_framebuffer(int32_t *width, int32_t *height)
+{
+    if (width) {
+        *width = headless_w;
+    }
+    if (height) {
+        *height = headless_h;
+    }
+    return headless_fb;
+}
+
+bool lvgl_port_screenshot(uint16_t *buf, size_t size, int32_t *width, int32_t *height)
+{
+    if (gui_gfx == NULL) {
+        return false;
+    }
+    const int32_t w = headless_fb ? headless_w : gui_gfx->width();
+    const int32_t h = headless_fb ? headless_h : gui_gfx->height();
+    if (width) {
+        *width = w;
+    }
+    if (height) {
+        *height = h;
+    }
+    if (buf == NULL || size < (size_t)w * h) {
+        return buf == NULL;
+    }
+
+    // Both hold the panel byte order once the flushes in flight are done
+    lvgl_port_flush_wait();
+    if (headless_fb) {
+        lvgl_port_rgb565_swap(buf, headless_fb, (size_t)w * h);
+    } else {
+        gui_gfx->readRect(0, 0, w, h, buf);
+        lvgl_port_rgb565_swap(buf, buf, (size_t)w * h);
+    }
+    return true;
+}
+
+bool lvgl_port_inject_touch(int32_t x, int32_t y, bool pressed, uint64_t *time_us)
+{
+#if LV_PORT_INPUT_QUEUE
+    if (input_gfx != NULL) {
+        return false;  // the sampler thread is the only producer of the input queue
+    }
+    lvgl_input_sample_t sample = {(int16_t)x, (int16_t)y, pressed, lvgl_port_tick_get()};
+    const uint64_t now         = lvgl_port_get_time_us();
+    if (!lvgl_input_push(&sample)) {
+        return false;
+    }
+    if (time_us) {
+        *time_us = now;
+    }
+    input_event = true;
+    lvgl_port_wake();
+    return true;
+#else
+    (void)x;
+    (void)y;
+    (void)pressed;
+    (void)time_us;
+    return false;
 #endif
+}
+
+void lvgl_port_probe_arm(const lv_area_t *area)
+{
+    probe_area = *area;
+    memset(&probe, 0, sizeof(probe));
+    probe_done_us.store(0, std::memory_order_relaxed);
+    probe_armed = true;
+}
+
+bool lvgl_port_probe_done(lvgl_port_probe_t *result)
+{
+    const uint64_t done_us = probe_done_us.load(std::memory_order_acquire);
+    if (done_us == 0) {
+        return false;
+    }
+    // The GUI thread wrote the other stamps before it submitted the probed frame
+    *result         = probe;
+    result->done_us = done_us;
+    return true;
+}
 
 bool lvgl_port_lock(void)
 {
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-    return xSemaphoreTake(xGuiSemaphore, portMAX_DELAY) == pdTRUE ? true : false;
-#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    return SDL_LockMutex(xGuiMutex) == 0 ? true : false;
+    return lvgl_port_take_gui_lock(NULL, __builtin_return_address(0), LVGL_PORT_LOCK_FOREVER);
+}
+
+bool lvgl_port_lock_timeout(uint32_t timeout_ms)
+{
+    return lvgl_port_take_gui_lock(NULL, __builtin_return_address(0), timeout_ms);
+}
+
+bool lvgl_port_trylock(void)
+{
+    return lvgl_port_take_gui_lock(NULL, __builtin_return_address(0), 0);
+}
+
+bool lvgl_port_lock_tagged(const char *label, uint32_t timeout_ms)
+{
+    return lvgl_port_take_gui_lock(label, __builtin_return_address(0), timeout_ms);
+}
+
+void lvgl_port_lock_profile_dump(void)
+{
+#if LV_PORT_LOCK_PROFILE
+    printf("%-32s %8s %10s %10s %10s %10s %6s\n", "holder", "count", "wait avg", "wait max", "hold avg", "hold max",
+           "over");
+    for (uint32_t i = 0; i < LVGL_LOCK_PROFILE_MAX && lock_profile[i].count; i++) {
+        const lvgl_lock_profile_t *p = &lock_profile[i];
+        char name[48];
+        lvgl_lock_holder_name(p->label, p->caller, name, sizeof(name));
+        printf("%-32s %8u %8u us %8u us %8u us %8u us %6u\n", name, (unsigned)p->count,
+               (unsigned)(p->wait_us / p->count), (unsigned)p->max_wait_us, (unsigned)(p->hold_us / p->count),
+               (unsigned)p->max_hold_us, (unsigned)p->over_budget);
+    }
+#else
+    printf("GUI lock profile: build with LV_PORT_LOCK_PROFILE=1\n");
 #endif
 }
 
+void lvgl_port_stop(void)
+{
+    lvgl_port_take_gui_lock(NULL, __builtin_return_address(0), LVGL_PORT_LOCK_FOREVER);
+    lvgl_port_flush_wait();
+}
+
 void lvgl_port_unlock(void)
 {
-#if defined(ARDUINO) && defined(ESP_PLATFORM)
-    xSemaphoreGive(xGuiSemaphore);
-#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
-    SDL_UnlockMutex(xGuiMutex);
-#endif
+    lvgl_port_give_gui_lock();
+    // The app may have changed the UI, let the GUI thread look at it now instead of at its next deadline
+    lvgl_port_wake();
+}
+
+void lvgl_port_touch_lock(void)
+{
+    touch_mutex.lock();
+}
+
+void lvgl_port_touch_unlock(void)
+{
+    touch_mutex.unlock();
 }
 
 #ifdef __cplusplus
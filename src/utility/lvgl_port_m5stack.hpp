@@ -6,14 +6,97 @@
 #endif
 #include <M5GFX.h>
 #include "lvgl.h"
+#include "lvgl_port_stats.hpp"
+#include "lvgl_port_post.hpp"
+#include "lvgl_port_session.hpp"
+#include "lvgl_port_heap.hpp"
+#include "lvgl_port_cache.hpp"
+#include "lvgl_port_glyph.hpp"
+#include "lvgl_port_pack.hpp"
+#include "lvgl_port_fs.hpp"
+#include "lvgl_port_gif.hpp"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define LVGL_PORT_LOCK_FOREVER UINT32_MAX
+
+typedef enum {
+    LVGL_PORT_RENDER_PARTIAL = 0,  // LV_BUFFER_LINE high stripes, two buffers where RAM allows
+    LVGL_PORT_RENDER_DIRECT,       // two full screen framebuffers, only dirty areas are rendered and sent
+    LVGL_PORT_RENDER_FULL,         // two full screen framebuffers, the whole screen is rendered and sent
+} lvgl_port_render_mode_t;
+
+typedef struct {
+    uint32_t frame;       // number of completed frames
+    uint32_t areas;       // areas flushed in the last frame
+    uint32_t pixels;      // pixels flushed in the last frame
+    uint32_t render_us;   // time LVGL spent rendering the last frame
+    uint32_t flush_us;    // time spent transferring the last frame to the panel
+    uint32_t frame_us;    // wall time from render start to the end of the last transfer
+    uint32_t convert_us;  // part of flush_us spent converting pixels to the panel byte order
+} lvgl_port_frame_info_t;
+
+typedef struct {
+    uint64_t read_us;    // the indev read handed the touch to LVGL
+    uint64_t render_us;  // LVGL started the frame that first redrew the probed area
+    uint64_t flush_us;   // the first flush of that frame covering the area started
+    uint64_t done_us;    // that frame reached the panel
+} lvgl_port_probe_t;
+
+// Call before lvgl_port_init() to override LV_PORT_RENDER_MODE
+void lvgl_port_set_render_mode(lvgl_port_render_mode_t mode);
 void lvgl_port_init(M5GFX &gfx);
 bool lvgl_port_lock(void);
+// Waits at most timeout_ms for the GUI lock (0: only tries), false when it was not acquired
+bool lvgl_port_lock_timeout(uint32_t timeout_ms);
+bool lvgl_port_trylock(void);
+// Like lvgl_port_lock_timeout(), `label` names the caller in the lock profile and its warnings
+// instead of the return address. Pass LVGL_PORT_LOCK_FOREVER to wait without a timeout.
+bool lvgl_port_lock_tagged(const char *label, uint32_t timeout_ms);
 void lvgl_port_unlock(void);
+// Held while the port reads the touch controller. Apps that read it themselves, e.g. gfx.getTouch(), take it
+// around the read. Independent of the GUI lock, any thread
+void lvgl_port_touch_lock(void);
+void lvgl_port_touch_unlock(void);
+// Makes the GUI thread run lv_timer_handler() now instead of at its next deadline, any thread
+void lvgl_port_wake(void);
+// Stops the GUI thread between two steps and waits for the flushes in flight, so the app can return and the
+// emulator shut SDL down. The GUI lock stays taken, nothing may use LVGL afterwards. Call without the GUI lock
+void lvgl_port_stop(void);
+// Prints count, wait and hold times per GUI lock holder (LV_PORT_LOCK_PROFILE builds). Call with the GUI lock held
+void lvgl_port_lock_profile_dump(void);
+// Any thread, the info is copied consistently while the transfer thread publishes the next frame
+void lvgl_port_get_frame_info(lvgl_port_frame_info_t *info);
+
+// Renders the invalidated areas right away and waits until they reached the panel, frame info included.
+// Call with the GUI lock held
+void lvgl_port_refresh_now(void);
+
+// Call before lvgl_port_init() to render into a memory framebuffer at the panel resolution instead of the panel.
+// On the emulator no window is opened and no events are pumped, sdl_main.cpp selects it with --headless
+// or LV_PORT_HEADLESS=1 in the environment.
+void lvgl_port_set_headless(bool enable);
+bool lvgl_port_is_headless(void);
+// Headless framebuffer, RGB565 in the panel byte order (big endian), NULL unless headless.
+// Call with the GUI lock held
+const uint16_t *lvgl_port_get_framebuffer(int32_t *width, int32_t *height);
+// Copies the frame that last reached the panel, without rendering again: the headless framebuffer, or the
+// panel's memory read back otherwise. RGB565 in the CPU byte order, `size` in pixels; with `buf` NULL only the
+// size is returned. False before lvgl_port_init() or when `buf` is too small. Call with the GUI lock held
+bool lvgl_port_screenshot(uint16_t *buf, size_t size, int32_t *width, int32_t *height);
+
+// Monotonic time [us] of the frame info, statistics and latency probe. Any thread
+uint64_t lvgl_port_get_time_us(void);
+// Queues a touch as if the panel had reported it and stores when (may be NULL). Any thread, headless only:
+// the input queue (LV_PORT_INPUT_QUEUE) takes samples from one producer, which otherwise is the sampler thread
+bool lvgl_port_inject_touch(int32_t x, int32_t y, bool pressed, uint64_t *time_us);
+// Touch-to-photon probe: times the next touch read and the first frame after it that redraws `area` (screen
+// coordinates) until it reached the panel. Call with the GUI lock held
+void lvgl_port_probe_arm(const lv_area_t *area);
+// Any thread, false until the probed frame reached the panel
+bool lvgl_port_probe_done(lvgl_port_probe_t *result);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,702 @@
+#include "lvgl.h"
+#include "lvgl_port_mem.h"
+#include "lvgl_port_tick.h"
+#include <cstring>  // for memcpy
+
+#if LV_PORT_MEM
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#elif __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#else
+#include <cstdlib>  // for malloc
+#endif
+
+#if LVGL_USE_V9 == 1 && LV_USE_OS != LV_OS_NONE
+#include <mutex>
+#define LVGL_MEM_LOCKED 1  // the draw threads allocate too
+#else
+#define LVGL_MEM_LOCKED 0
+#endif
+
+// Two level segregated fit (Masmano et al.): free blocks are kept in lists by size, the first level a power of
+// two and the second level LVGL_TLSF_SL_COUNT steps within it. Two bitmaps find a fitting list in O(1), neighbours
+// are merged on free, so allocation and free take the same time however fragmented the pool is.
+#define LVGL_TLSF_ALIGN      sizeof(size_t)
+#define LVGL_TLSF_ALIGN_LOG2 (sizeof(size_t) == 8 ? 3 : 2)
+#define LVGL_TLSF_SL_LOG2    4
+#define LVGL_TLSF_SL_COUNT   (1 << LVGL_TLSF_SL_LOG2)
+#define LVGL_TLSF_FL_MAX     30  // blocks up to 1 GB
+#define LVGL_TLSF_FL_SHIFT   (LVGL_TLSF_SL_LOG2 + LVGL_TLSF_ALIGN_LOG2)
+#define LVGL_TLSF_FL_COUNT   (LVGL_TLSF_FL_MAX - LVGL_TLSF_FL_SHIFT + 1)
+#define LVGL_TLSF_SMALL      ((size_t)1 << LVGL_TLSF_FL_SHIFT)  // below: one first level list, linear steps
+#define LVGL_TLSF_FREE       ((size_t)1)
+#define LVGL_TLSF_PREV_FREE  ((size_t)2)
+#define LVGL_TLSF_POOLS      32  // each grown region is at least as large as all pools before it
+
+// Small allocations share segments of one size class each: no per object header, and a segment goes back to
+// the pool once its last object is freed.
+#define LVGL_SLAB_SEG_SIZE 4096
+#define LVGL_SLAB_SEG_MAX  512  // segments tracked, beyond that small allocations fall back to the pool
+#define LVGL_SLAB_MAX      256  // largest slab size class
+#define LVGL_SLAB_CLASSES  12
+
+typedef struct lvgl_tlsf_block {
+    struct lvgl_tlsf_block *prev_phys;  // only valid while the previous block is free, overlaps its last word
+    size_t size;                        // payload bytes | LVGL_TLSF_FREE | LVGL_TLSF_PREV_FREE
+    struct lvgl_tlsf_block *next_free;  // free blocks only, the payload of used blocks starts here
+    struct lvgl_tlsf_block *prev_free;
+} lvgl_tlsf_block_t;
+
+#define LVGL_TLSF_OVERHEAD sizeof(size_t)  // bytes a used block costs on top of its payload
+#define LVGL_TLSF_PAYLOAD  offsetof(lvgl_tlsf_block_t, next_free)
+#define LVGL_TLSF_MIN      (sizeof(lvgl_tlsf_block_t) - sizeof(lvgl_tlsf_block_t *))
+#define LVGL_TLSF_MAX      ((size_t)1 << (LVGL_TLSF_FL_MAX - 1))
+
+typedef struct {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[LVGL_TLSF_FL_COUNT];
+    lvgl_tlsf_block_t *blocks[LVGL_TLSF_FL_COUNT][LVGL_TLSF_SL_COUNT];
+    struct {
+        void *mem;
+        size_t size;      // payload of the pool's first block
+        void *map;        // region from lvgl_mem_map(), NULL for the static pool and lv_mem_add_pool()
+        size_t map_size;  // [bytes]
+    } pools[LVGL_TLSF_POOLS];
+    uint32_t pool_cnt;
+    size_t total;
+    size_t used;
+    size_t max_used;
+} lvgl_tlsf_t;
+
+typedef struct lvgl_slab_seg {
+    struct lvgl_slab_seg *next;  // segments of the class with free objects
+    struct lvgl_slab_seg *prev;
+    void *free;                  // freed objects, linked through their first word
+    uint16_t used;               // objects handed out
+    uint16_t bump;               // objects from here on were never handed out
+    uint16_t count;
+    uint8_t cls;
+} lvgl_slab_seg_t;
+
+#define LVGL_SLAB_HEADER (((sizeof(lvgl_slab_seg_t) + 7) / 8) * 8)
+
+static const uint16_t slab_sizes[LVGL_SLAB_CLASSES] = {8, 16, 24, 32, 48, 64, 80, 96, 128, 160, 192, 256};
+// Size class of a request of up to 8 * i bytes
+static const uint8_t slab_class_of[LVGL_SLAB_MAX / 8 + 1] = {0, 0, 1, 2, 3, 4,  4,  5,  5,  6,  6,  7,  7,  8,  8,  8, 8,
+                                                              9, 9, 9, 9, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11};
+
+static lvgl_tlsf_t tlsf;
+static lvgl_slab_seg_t *slab_partial[LVGL_SLAB_CLASSES];  // segments with room, per class
+static uintptr_t slab_segs[LVGL_SLAB_SEG_MAX];            // all segments, sorted by address
+static uint32_t slab_seg_cnt;
+static size_t slab_used;
+static uint32_t mem_allocs;
+static uint32_t mem_frees;
+static uint32_t rate_allocs;  // mem_allocs at the previous lvgl_port_mem_get_stats()
+static uint32_t rate_tick;
+static bool mem_ready;
+alignas(8) static uint8_t mem_pool[LV_PORT_MEM_POOL_SIZE];
+#if LVGL_MEM_LOCKED
+static std::mutex mem_mutex;
+#define LVGL_MEM_LOCK() std::lock_guard<std::mutex> lvgl_mem_guard(mem_mutex)
+#else
+#define LVGL_MEM_LOCK()
+#endif
+
+static inline int lvgl_tlsf_fls(size_t x)
+{
+    return (int)(sizeof(unsigned long long) * 8 - 1) - __builtin_clzll((unsigned long long)x);
+}
+
+static inline size_t lvgl_tlsf_size(const lvgl_tlsf_block_t *b)
+{
+    return b->size & ~(LVGL_TLSF_FREE | LVGL_TLSF_PREV_FREE);
+}
+
+static inline void *lvgl_tlsf_payload(lvgl_tlsf_block_t *b)
+{
+    return (uint8_t *)b + LVGL_TLSF_PAYLOAD;
+}
+
+static inline lvgl_tlsf_block_t *lvgl_tlsf_block(void *p)
+{
+    return (lvgl_tlsf_block_t *)((uint8_t *)p - LVGL_TLSF_PAYLOAD);
+}
+
+static inline lvgl_tlsf_block_t *lvgl_tlsf_next(lvgl_tlsf_block_t *b)
+{
+    return (lvgl_tlsf_block_t *)((uint8_t *)lvgl_tlsf_payload(b) + lvgl_tlsf_size(b) - LVGL_TLSF_OVERHEAD);
+}
+
+static void lvgl_tlsf_mapping(size_t size, int *fl, int *sl)
+{
+    if (size < LVGL_TLSF_SMALL) {
+        *fl = 0;
+        *sl = (int)(size / (LVGL_TLSF_SMALL / LVGL_TLSF_SL_COUNT));
+    } else {
+        const int f = lvgl_tlsf_fls(size);
+        *sl         = (int)(size >> (f - LVGL_TLSF_SL_LOG2)) ^ LVGL_TLSF_SL_COUNT;
+        *fl         = f - (LVGL_TLSF_FL_SHIFT - 1);
+    }
+}
+
+static void lvgl_tlsf_insert(lvgl_tlsf_block_t *b)
+{
+    int fl, sl;
+    lvgl_tlsf_mapping(lvgl_tlsf_size(b), &fl, &sl);
+    lvgl_tlsf_block_t *head = tlsf.blocks[fl][sl];
+    b->next_free            = head;
+    b->prev_free            = NULL;
+    if (head) {
+        head->prev_free = b;
+    }
+    tlsf.blocks[fl][sl] = b;
+    tlsf.fl_bitmap |= 1U << fl;
+    tlsf.sl_bitmap[fl] |= 1U << sl;
+}
+
+static void lvgl_tlsf_remove(lvgl_tlsf_block_t *b)
+{
+    int fl, sl;
+    lvgl_tlsf_mapping(lvgl_tlsf_size(b), &fl, &sl);
+    if (b->next_free) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+        return;
+    }
+    tlsf.blocks[fl][sl] = b->next_free;
+    if (b->next_free == NULL) {
+        tlsf.sl_bitmap[fl] &= ~(1U << sl);
+        if (tlsf.sl_bitmap[fl] == 0) {
+            tlsf.fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+static bool lvgl_tlsf_add_pool(void *mem, size_t bytes)
+{
+    const uintptr_t start = ((uintptr_t)mem + LVGL_TLSF_ALIGN - 1) & ~(uintptr_t)(LVGL_TLSF_ALIGN - 1);
+    bytes -= start - (uintptr_t)mem;
+    if (tlsf.pool_cnt == LVGL_TLSF_POOLS || bytes < 2 * LVGL_TLSF_OVERHEAD + LVGL_TLSF_MIN) {
+        return false;
+    }
+    size_t size = (bytes - 2 * LVGL_TLSF_OVERHEAD) & ~(size_t)(LVGL_TLSF_ALIGN - 1);
+    if (size > LVGL_TLSF_MAX) {
+        size = LVGL_TLSF_MAX;
+    }
+
+    // The first block's prev_phys lies before the pool, it is never read as nothing precedes the block
+    lvgl_tlsf_block_t *b = (lvgl_tlsf_block_t *)(start - LVGL_TLSF_OVERHEAD);
+    b->size              = size | LVGL_TLSF_FREE;
+    lvgl_tlsf_insert(b);
+    // Zero sized used block at the end, merging stops there
+    lvgl_tlsf_block_t *sentinel = lvgl_tlsf_next(b);
+    sentinel->prev_phys         = b;
+    sentinel->size              = LVGL_TLSF_PREV_FREE;
+
+    tlsf.pools[tlsf.pool_cnt].mem      = (void *)start;
+    tlsf.pools[tlsf.pool_cnt].size     = size;
+    tlsf.pools[tlsf.pool_cnt].map      = NULL;
+    tlsf.pools[tlsf.pool_cnt].map_size = 0;
+    tlsf.pool_cnt++;
+    tlsf.total += size;
+    return true;
+}
+
+static void *lvgl_tlsf_alloc(size_t size)
+{
+    if (size > LVGL_TLSF_MAX) {
+        return NULL;
+    }
+    size = (size + LVGL_TLSF_ALIGN - 1) & ~(size_t)(LVGL_TLSF_ALIGN - 1);
+    if (size < LVGL_TLSF_MIN) {
+        size = LVGL_TLSF_MIN;
+    }
+
+    // Round up to the next list so that every block of the one found fits
+    size_t search = size;
+    if (search >= LVGL_TLSF_SMALL) {
+        search += ((size_t)1 << (lvgl_tlsf_fls(search) - LVGL_TLSF_SL_LOG2)) - 1;
+    }
+    int fl, sl;
+    lvgl_tlsf_mapping(search, &fl, &sl);
+    if (fl >= LVGL_TLSF_FL_COUNT) {
+        return NULL;
+    }
+    uint32_t sl_map = tlsf.sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        const uint32_t fl_map = tlsf.fl_bitmap & (~0U << (fl + 1));
+        if (fl_map == 0) {
+            return NULL;
+        }
+        fl     = __builtin_ctz(fl_map);
+        sl_map = tlsf.sl_bitmap[fl];
+    }
+    sl                   = __builtin_ctz(sl_map);
+    lvgl_tlsf_block_t *b = tlsf.blocks[fl][sl];
+    lvgl_tlsf_remove(b);
+
+    if (lvgl_tlsf_size(b) >= size + sizeof(lvgl_tlsf_block_t)) {
+        // Split, the rest stays free
+        lvgl_tlsf_block_t *rest =
+            (lvgl_tlsf_block_t *)((uint8_t *)lvgl_tlsf_payload(b) + size - LVGL_TLSF_OVERHEAD);
+        rest->size                      = (lvgl_tlsf_size(b) - size - LVGL_TLSF_OVERHEAD) | LVGL_TLSF_FREE;
+        b->size                         = size | (b->size & LVGL_TLSF_PREV_FREE);
+        lvgl_tlsf_next(rest)->prev_phys = rest;
+        lvgl_tlsf_insert(rest);
+    } else {
+        lvgl_tlsf_next(b)->size &= ~LVGL_TLSF_PREV_FREE;
+    }
+    b->size &= ~LVGL_TLSF_FREE;
+
+    tlsf.used += lvgl_tlsf_size(b) + LVGL_TLSF_OVERHEAD;
+    if (tlsf.used > tlsf.max_used) {
+        tlsf.max_used = tlsf.used;
+    }
+    return lvgl_tlsf_payload(b);
+}
+
+// Takes the pool out if nothing in it is allocated, returns whether it did
+static bool lvgl_tlsf_remove_pool(uint32_t i)
+{
+    lvgl_tlsf_block_t *b = (lvgl_tlsf_block_t *)((uint8_t *)tlsf.pools[i].mem - LVGL_TLSF_OVERHEAD);
+    if (!(b->size & LVGL_TLSF_FREE) || lvgl_tlsf_size(b) != tlsf.pools[i].size) {
+        return false;
+    }
+    lvgl_tlsf_remove(b);
+    tlsf.total -= tlsf.pools[i].size;
+    tlsf.pool_cnt--;
+    memmove(&tlsf.pools[i], &tlsf.pools[i + 1], (tlsf.pool_cnt - i) * sizeof(tlsf.pools[0]));
+    return true;
+}
+
+// Returns the free block p ended up in after merging with its neighbours
+static lvgl_tlsf_block_t *lvgl_tlsf_free(void *p)
+{
+    lvgl_tlsf_block_t *b = lvgl_tlsf_block(p);
+    tlsf.used -= lvgl_tlsf_size(b) + LVGL_TLSF_OVERHEAD;
+    b->size |= LVGL_TLSF_FREE;
+
+    if (b->size & LVGL_TLSF_PREV_FREE) {
+        lvgl_tlsf_block_t *prev = b->prev_phys;
+        lvgl_tlsf_remove(prev);
+        prev->size += lvgl_tlsf_size(b) + LVGL_TLSF_OVERHEAD;
+        b = prev;
+    }
+    lvgl_tlsf_block_t *next = lvgl_tlsf_next(b);
+    if (next->size & LVGL_TLSF_FREE) {
+        lvgl_tlsf_remove(next);
+        b->size += lvgl_tlsf_size(next) + LVGL_TLSF_OVERHEAD;
+        next = lvgl_tlsf_next(b);
+    }
+    next->prev_phys = b;
+    next->size |= LVGL_TLSF_PREV_FREE;
+    lvgl_tlsf_insert(b);
+    return b;
+}
+
+static void *lvgl_mem_map(size_t bytes)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#if defined(BOARD_HAS_PSRAM)
+    return heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#else
+    return heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#endif
+#elif __has_include(<sys/mman.h>)
+    void *mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return mem == MAP_FAILED ? NULL : mem;
+#else
+    return malloc(bytes);
+#endif
+}
+
+static void lvgl_mem_unmap(void *mem, size_t bytes)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    (void)bytes;
+    heap_caps_free(mem);
+#elif __has_include(<sys/mman.h>)
+    munmap(mem, bytes);
+#else
+    (void)bytes;
+    free(mem);
+#endif
+}
+
+// Adds a region large enough for a block of size bytes. Regions grow geometrically, at least as large as all
+// pools so far, so the LVGL_TLSF_POOLS slots cover any heap the system can give
+static bool lvgl_mem_grow(size_t size)
+{
+    size_t need = size + 2 * LVGL_TLSF_OVERHEAD + sizeof(lvgl_tlsf_block_t) + LVGL_TLSF_ALIGN;
+    need += (size_t)1 << (lvgl_tlsf_fls(need) - LVGL_TLSF_SL_LOG2);  // the rounding up of lvgl_tlsf_alloc()
+    need = (LV_MAX(need, (size_t)LV_PORT_MEM_GROW_SIZE) + 4095) & ~(size_t)4095;
+    if (tlsf.pool_cnt == LVGL_TLSF_POOLS || (LV_PORT_MEM_MAX_SIZE && tlsf.total + need > LV_PORT_MEM_MAX_SIZE)) {
+        LV_LOG_WARN("lvgl_port_mem: cannot grow by %u bytes", (unsigned)need);
+        return false;
+    }
+    size_t bytes = LV_MAX(need, (tlsf.total + 4095) & ~(size_t)4095);
+    bytes        = LV_MIN(bytes, LVGL_TLSF_MAX);
+    if (LV_PORT_MEM_MAX_SIZE) {
+        bytes = LV_MIN(bytes, LV_PORT_MEM_MAX_SIZE - tlsf.total);
+    }
+    bytes     = LV_MAX(bytes, need);
+    void *mem = lvgl_mem_map(bytes);
+    if (mem == NULL && bytes > need) {
+        bytes = need;  // the system has less to give, take just enough
+        mem   = lvgl_mem_map(bytes);
+    }
+    if (mem == NULL) {
+        LV_LOG_WARN("lvgl_port_mem: cannot grow by %u bytes", (unsigned)bytes);
+        return false;
+    }
+    if (!lvgl_tlsf_add_pool(mem, bytes)) {
+        lvgl_mem_unmap(mem, bytes);
+        return false;
+    }
+    tlsf.pools[tlsf.pool_cnt - 1].map      = mem;
+    tlsf.pools[tlsf.pool_cnt - 1].map_size = bytes;
+    return true;
+}
+
+// Gives a grown region back to the system once the free block b spans all of it
+static void lvgl_mem_trim(lvgl_tlsf_block_t *b)
+{
+    if (lvgl_tlsf_size(lvgl_tlsf_next(b)) != 0) {
+        return;  // only the zero sized sentinel ends a pool
+    }
+    for (uint32_t i = 0; i < tlsf.pool_cnt; i++) {
+        if ((uint8_t *)tlsf.pools[i].mem - LVGL_TLSF_OVERHEAD != (uint8_t *)b) {
+            continue;
+        }
+        void *map             = tlsf.pools[i].map;
+        const size_t map_size = tlsf.pools[i].map_size;
+        if (map && lvgl_tlsf_remove_pool(i)) {
+            lvgl_mem_unmap(map, map_size);
+        }
+        return;
+    }
+}
+
+static void *lvgl_mem_pool_alloc(size_t size)
+{
+    void *p = lvgl_tlsf_alloc(size);
+    if (p == NULL && lvgl_mem_grow(size)) {
+        p = lvgl_tlsf_alloc(size);
+    }
+    return p;
+}
+
+static void lvgl_mem_init(void)
+{
+    if (!mem_ready) {
+        mem_ready = true;
+        lvgl_tlsf_add_pool(mem_pool, sizeof(mem_pool));
+    }
+}
+
+static lvgl_slab_seg_t *lvgl_slab_find(const void *p)
+{
+    const uintptr_t a = (uintptr_t)p;
+    if (slab_seg_cnt == 0 || a < slab_segs[0] || a >= slab_segs[slab_seg_cnt - 1] + LVGL_SLAB_SEG_SIZE) {
+        return NULL;
+    }
+    uint32_t lo = 0, hi = slab_seg_cnt;  // the last segment starting at or below a is in [lo, hi)
+    while (hi - lo > 1) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (slab_segs[mid] <= a) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return a < slab_segs[lo] + LVGL_SLAB_SEG_SIZE ? (lvgl_slab_seg_t *)slab_segs[lo] : NULL;
+}
+
+static void lvgl_slab_link(lvgl_slab_seg_t *seg)
+{
+    seg->prev = NULL;
+    seg->next = slab_partial[seg->cls];
+    if (seg->next) {
+        seg->next->prev = seg;
+    }
+    slab_partial[seg->cls] = seg;
+}
+
+static void lvgl_slab_unlink(lvgl_slab_seg_t *seg)
+{
+    if (seg->next) {
+        seg->next->prev = seg->prev;
+    }
+    if (seg->prev) {
+        seg->prev->next = seg->next;
+    } else {
+        slab_partial[seg->cls] = seg->next;
+    }
+}
+
+static lvgl_slab_seg_t *lvgl_slab_seg_new(uint8_t cls)
+{
+    if (slab_seg_cnt == LVGL_SLAB_SEG_MAX) {
+        return NULL;
+    }
+    lvgl_slab_seg_t *seg = (lvgl_slab_seg_t *)lvgl_mem_pool_alloc(LVGL_SLAB_SEG_SIZE);
+    if (seg == NULL) {
+        return NULL;
+    }
+    uint32_t i = slab_seg_cnt;
+    for (; i > 0 && slab_segs[i - 1] > (uintptr_t)seg; i--) {
+        slab_segs[i] = slab_segs[i - 1];
+    }
+    slab_segs[i] = (uintptr_t)seg;
+    slab_seg_cnt++;
+
+    seg->free  = NULL;
+    seg->used  = 0;
+    seg->bump  = 0;
+    seg->count = (LVGL_SLAB_SEG_SIZE - LVGL_SLAB_HEADER) / slab_sizes[cls];
+    seg->cls   = cls;
+    lvgl_slab_link(seg);
+    return seg;
+}
+
+static void lvgl_slab_seg_release(lvgl_slab_seg_t *seg)
+{
+    lvgl_slab_unlink(seg);
+    uint32_t i = 0;
+    while (slab_segs[i] != (uintptr_t)seg) {
+        i++;
+    }
+    slab_seg_cnt--;
+    memmove(&slab_segs[i], &slab_segs[i + 1], (slab_seg_cnt - i) * sizeof(slab_segs[0]));
+    lvgl_mem_trim(lvgl_tlsf_free(seg));
+}
+
+static void *lvgl_slab_alloc(uint8_t cls)
+{
+    lvgl_slab_seg_t *seg = slab_partial[cls];
+    if (seg == NULL && (seg = lvgl_slab_seg_new(cls)) == NULL) {
+        return NULL;
+    }
+    void *obj = seg->free;
+    if (obj) {
+        seg->free = *(void **)obj;
+    } else {
+        obj = (uint8_t *)seg + LVGL_SLAB_HEADER + seg->bump++ * slab_sizes[cls];
+    }
+    if (++seg->used == seg->count) {
+        lvgl_slab_unlink(seg);
+    }
+    slab_used += slab_sizes[cls];
+    return obj;
+}
+
+static void lvgl_slab_free(lvgl_slab_seg_t *seg, void *obj)
+{
+    *(void **)obj = seg->free;
+    seg->free     = obj;
+    slab_used -= slab_sizes[seg->cls];
+    if (seg->used-- == seg->count) {
+        lvgl_slab_link(seg);
+    }
+    // Keep one segment with room per class so that alternating alloc / free does not churn the pool, unless it
+    // would keep a grown region from going back to the system
+    const bool grown = (uint8_t *)seg < mem_pool || (uint8_t *)seg >= mem_pool + sizeof(mem_pool);
+    if (seg->used == 0 && (seg->next || seg->prev || grown)) {
+        lvgl_slab_seg_release(seg);
+    }
+}
+
+static void *lvgl_mem_alloc(size_t size)
+{
+    lvgl_mem_init();
+    void *p = NULL;
+    if (size <= LVGL_SLAB_MAX) {
+        p = lvgl_slab_alloc(slab_class_of[(size + 7) / 8]);
+    }
+    if (p == NULL) {
+        p = lvgl_mem_pool_alloc(size);
+    }
+    if (p) {
+        mem_allocs++;
+    }
+    return p;
+}
+
+static void lvgl_mem_free(void *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    lvgl_slab_seg_t *seg = lvgl_slab_find(p);
+    if (seg) {
+        lvgl_slab_free(seg, p);
+    } else {
+        lvgl_mem_trim(lvgl_tlsf_free(p));
+    }
+    mem_frees++;
+}
+
+extern "C" void *lvgl_port_mem_alloc(size_t size)
+{
+    LVGL_MEM_LOCK();
+    return lvgl_mem_alloc(size);
+}
+
+extern "C" void lvgl_port_mem_free(void *p)
+{
+    LVGL_MEM_LOCK();
+    lvgl_mem_free(p);
+}
+
+extern "C" void *lvgl_port_mem_realloc(void *p, size_t size)
+{
+    LVGL_MEM_LOCK();
+    if (p == NULL) {
+        return lvgl_mem_alloc(size);
+    }
+    if (size == 0) {
+        lvgl_mem_free(p);
+        return NULL;
+    }
+    lvgl_slab_seg_t *seg = lvgl_slab_find(p);
+    const size_t old     = seg ? slab_sizes[seg->cls] : lvgl_tlsf_size(lvgl_tlsf_block(p));
+    if (size <= old) {
+        return p;
+    }
+    void *q = lvgl_mem_alloc(size);
+    if (q) {
+        memcpy(q, p, old);
+        lvgl_mem_free(p);
+    }
+    return q;
+}
+
+extern "C" void lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats)
+{
+    LVGL_MEM_LOCK();
+    memset(stats, 0, sizeof(*stats));
+    for (int fl = 0; fl < LVGL_TLSF_FL_COUNT; fl++) {
+        for (int sl = 0; sl < LVGL_TLSF_SL_COUNT; sl++) {
+            for (lvgl_tlsf_block_t *b = tlsf.blocks[fl][sl]; b; b = b->next_free) {
+                stats->free_cnt++;
+                if (lvgl_tlsf_size(b) > stats->free_biggest) {
+                    stats->free_biggest = lvgl_tlsf_size(b);
+                }
+            }
+        }
+    }
+    const size_t free_size = tlsf.total > tlsf.used ? tlsf.total - tlsf.used : 0;
+    stats->total           = tlsf.total;
+    stats->used            = tlsf.used;
+    stats->max_used        = tlsf.max_used;
+    stats->frag_pct        = free_size ? (uint8_t)(100 - (uint64_t)stats->free_biggest * 100 / free_size) : 0;
+    stats->pools           = tlsf.pool_cnt;
+    stats->slab_segments   = slab_seg_cnt;
+    stats->slab_used       = slab_used;
+    stats->allocs          = mem_allocs;
+    stats->frees           = mem_frees;
+
+    const uint32_t tick    = lvgl_port_tick_get();
+    const uint32_t elapsed = tick - rate_tick;
+    stats->alloc_rate      = elapsed ? (uint32_t)((uint64_t)(mem_allocs - rate_allocs) * 1000 / elapsed) : 0;
+    rate_allocs            = mem_allocs;
+    rate_tick              = tick;
+}
+
+#if LVGL_USE_V9 == 1 && LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+// LV_STDLIB_CUSTOM: LVGL's lv_malloc() family ends up here
+
+extern "C" void lv_mem_init(void)
+{
+    LVGL_MEM_LOCK();
+    lvgl_mem_init();
+}
+
+extern "C" void lv_mem_deinit(void)
+{
+    // The pools stay, a following lv_init() continues with them
+}
+
+extern "C" lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    LVGL_MEM_LOCK();
+    lvgl_mem_init();
+    return lvgl_tlsf_add_pool(mem, bytes) ? tlsf.pools[tlsf.pool_cnt - 1].mem : NULL;
+}
+
+extern "C" void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    LVGL_MEM_LOCK();
+    for (uint32_t i = 0; i < tlsf.pool_cnt; i++) {
+        if (tlsf.pools[i].mem != pool) {
+            continue;
+        }
+        if (!lvgl_tlsf_remove_pool(i)) {
+            LV_LOG_WARN("lvgl_port_mem: pool %p still in use", pool);
+        }
+        return;
+    }
+}
+
+extern "C" void *lv_malloc_core(size_t size)
+{
+    return lvgl_port_mem_alloc(size);
+}
+
+extern "C" void *lv_realloc_core(void *p, size_t new_size)
+{
+    return lvgl_port_mem_realloc(p, new_size);
+}
+
+extern "C" void lv_free_core(void *p)
+{
+    lvgl_port_mem_free(p);
+}
+
+extern "C" void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    lvgl_port_mem_stats_t stats;
+    lvgl_port_mem_get_stats(&stats);
+    mon_p->total_size        = stats.total;
+    mon_p->free_size         = stats.total - stats.used;
+    mon_p->free_cnt          = stats.free_cnt;
+    mon_p->free_biggest_size = stats.free_biggest;
+    mon_p->used_cnt          = stats.allocs - stats.frees;
+    mon_p->max_used          = stats.max_used;
+    mon_p->used_pct          = stats.total ? (uint8_t)((uint64_t)stats.used * 100 / stats.total) : 0;
+    mon_p->frag_pct          = stats.frag_pct;
+}
+
+// Walks every pool block by block and checks the headers against their neighbours and the free lists
+extern "C" lv_result_t lv_mem_test_core(void)
+{
+    LVGL_MEM_LOCK();
+    for (uint32_t i = 0; i < tlsf.pool_cnt; i++) {
+        lvgl_tlsf_block_t *b = (lvgl_tlsf_block_t *)((uint8_t *)tlsf.pools[i].mem - LVGL_TLSF_OVERHEAD);
+        bool prev_free       = false;
+        while (lvgl_tlsf_size(b)) {
+            const bool is_free = b->size & LVGL_TLSF_FREE;
+            if (prev_free != !!(b->size & LVGL_TLSF_PREV_FREE) || (prev_free && is_free)) {
+                return LV_RESULT_INVALID;
+            }
+            lvgl_tlsf_block_t *next = lvgl_tlsf_next(b);
+            if (is_free && next->prev_phys != b) {
+                return LV_RESULT_INVALID;
+            }
+            prev_free = is_free;
+            b         = next;
+        }
+        if (prev_free != !!(b->size & LVGL_TLSF_PREV_FREE)) {
+            return LV_RESULT_INVALID;
+        }
+    }
+    return LV_RESULT_OK;
+}
+#endif
+
+#endif  // LV_PORT_MEM
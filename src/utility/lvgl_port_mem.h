@@ -0,0 +1,59 @@
+#ifndef __LVGL_PORT_MEM_H__
+#define __LVGL_PORT_MEM_H__
+
+// Plain C so lv_conf.h can hand it to LVGL as the allocator (LV_MEM_CUSTOM_INCLUDE in v8, LV_STDLIB_CUSTOM in v9).
+// Enabled with LV_PORT_MEM=1.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes the allocator starts with, a static array in internal RAM
+#ifndef LV_PORT_MEM_POOL_SIZE
+#define LV_PORT_MEM_POOL_SIZE (64U * 1024U)
+#endif
+
+// Smallest region added once the pools run out: PSRAM on boards with it, mmap'ed pages on the emulator. Each
+// region is also at least as large as all pools so far, and goes back to the system once entirely free
+#ifndef LV_PORT_MEM_GROW_SIZE
+#define LV_PORT_MEM_GROW_SIZE (256U * 1024U)
+#endif
+
+// Upper bound of all pools together [bytes], 0: grow as long as the system has memory
+#ifndef LV_PORT_MEM_MAX_SIZE
+#define LV_PORT_MEM_MAX_SIZE 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    size_t total;          // bytes in all pools
+    size_t used;           // bytes taken from the pools, block headers and slab segments included
+    size_t max_used;
+    size_t free_biggest;   // largest allocation the pools can serve without growing
+    uint32_t free_cnt;     // free blocks in the pools
+    uint8_t frag_pct;      // 100 - free_biggest / free, 0 while the free memory is one block
+    uint32_t pools;        // the static pool plus every region grown into
+    uint32_t slab_segments;
+    size_t slab_used;      // bytes of the small allocations the slab segments hold
+    uint32_t allocs;       // calls since start
+    uint32_t frees;
+    uint32_t alloc_rate;   // allocations per second since the previous lvgl_port_mem_get_stats() call
+} lvgl_port_mem_stats_t;
+
+// LVGL's malloc / free / realloc. Small requests come from per size class slabs, the rest from a TLSF pool
+// that grows on demand. LVGL calls them with the GUI lock held; with its OS layer enabled (LV_PORT_DRAW_UNITS > 1)
+// the draw threads allocate as well and the allocator takes a mutex of its own.
+void *lvgl_port_mem_alloc(size_t size);
+void lvgl_port_mem_free(void *p);
+void *lvgl_port_mem_realloc(void *p, size_t size);
+
+// Snapshot of the allocator, call with the GUI lock held
+void lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_MEM_H__
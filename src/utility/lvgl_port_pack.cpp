@@ -0,0 +1,481 @@
+#include "lvgl_port_pack.hpp"
+#include <cstdio>   // for fopen, printf
+#include <cstdlib>  // for calloc, malloc
+#include <cstring>  // for memcpy, strncmp
+
+#if LV_PORT_PACK
+
+#if LVGL_USE_V9 == 1
+#include "lvgl_private.h"  // for lv_image_decoder_add_to_cache
+#endif
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#elif __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Layout written by support/asset_pack.py, little endian like every target
+#define LVGL_PACK_MAGIC    0x4B50564CU  // "LVPK"
+#define LVGL_PACK_VERSION  1
+#define LVGL_PACK_NAME_LEN 32
+
+typedef enum {
+    LVGL_PACK_RGB565   = 0,
+    LVGL_PACK_ARGB8565 = 1,  // RGB565 and 8 bit alpha per pixel
+} lvgl_pack_format_t;
+
+typedef enum {
+    LVGL_PACK_RAW = 0,
+    LVGL_PACK_LZ4 = 1,
+} lvgl_pack_compression_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t index;  // offset of the first entry
+    uint32_t size;
+} lvgl_pack_header_t;
+
+typedef struct {
+    char name[LVGL_PACK_NAME_LEN];  // sorted, NUL padded
+    uint16_t w;
+    uint16_t h;
+    uint8_t format;
+    uint8_t compression;
+    uint16_t flags;
+    uint32_t offset;
+    uint32_t size;      // stored
+    uint32_t raw_size;  // decoded
+} lvgl_pack_entry_t;
+static_assert(sizeof(lvgl_pack_header_t) == 16 && sizeof(lvgl_pack_entry_t) == 52, "asset_pack.py layout");
+
+typedef struct {
+    const uint8_t *data;
+    const lvgl_pack_entry_t *entries;
+    uint32_t count;
+#if LVGL_USE_V8 == 1
+    lv_img_dsc_t *images;  // the sources lvgl_port_pack_image() hands out, one per entry
+#else
+    lv_image_dsc_t *images;
+#endif
+} lvgl_pack_t;
+
+static lvgl_pack_t packs[LV_PORT_PACKS];
+static uint32_t pack_cnt;
+
+// LZ4 block format, bounds checked against both buffers. Returns false unless exactly dst_size bytes came out
+static bool lvgl_pack_lz4(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size)
+{
+    const uint8_t *ip     = src;
+    const uint8_t *ip_end = src + src_size;
+    uint8_t *op           = dst;
+    uint8_t *op_end       = dst + dst_size;
+    while (ip < ip_end) {
+        const uint8_t token = *ip++;
+        uint32_t len        = token >> 4;
+        if (len == 15) {
+            uint8_t b;
+            do {
+                if (ip == ip_end) {
+                    return false;
+                }
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        if (len > (uint32_t)(ip_end - ip) || len > (uint32_t)(op_end - op)) {
+            return false;
+        }
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+        if (ip == ip_end) {
+            break;  // the last sequence has literals only
+        }
+
+        if (ip_end - ip < 2) {
+            return false;
+        }
+        const uint32_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (uint32_t)(op - dst)) {
+            return false;
+        }
+        len = (token & 15) + 4;
+        if ((token & 15) == 15) {
+            uint8_t b;
+            do {
+                if (ip == ip_end) {
+                    return false;
+                }
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        if (len > (uint32_t)(op_end - op)) {
+            return false;
+        }
+        const uint8_t *match = op - offset;
+        if (offset >= len) {
+            memcpy(op, match, len);
+            op += len;
+        } else {
+            // Overlapping match, repeats the last `offset` bytes
+            for (uint32_t i = 0; i < len; i++) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return op == op_end;
+}
+
+// The entry and its data if `src` is one of the packs' image sources
+static const lvgl_pack_entry_t *lvgl_pack_entry(const void *src, const uint8_t **data)
+{
+    for (uint32_t i = 0; i < pack_cnt; i++) {
+        const lvgl_pack_t *p = &packs[i];
+        if (src >= (const void *)p->images && src < (const void *)(p->images + p->count)) {
+            const lvgl_pack_entry_t *e = &p->entries[(decltype(p->images))src - p->images];
+            if (data) {
+                *data = p->data + e->offset;
+            }
+            return e;
+        }
+    }
+    return NULL;
+}
+
+// Decoded images can be far larger than LVGL's heap: PSRAM on boards with it, the system heap otherwise.
+// Released with free()
+static uint8_t *lvgl_pack_buf_alloc(size_t size)
+{
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && defined(BOARD_HAS_PSRAM)
+    return (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#else
+    return (uint8_t *)malloc(size);
+#endif
+}
+
+#if LVGL_USE_V8 == 1
+static lv_res_t lvgl_pack_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header)
+{
+    (void)decoder;
+    const lvgl_pack_entry_t *e = lvgl_pack_entry(src, NULL);
+    if (e == NULL) {
+        return LV_RES_INV;
+    }
+    header->always_zero = 0;
+    header->cf          = e->format == LVGL_PACK_ARGB8565 ? LV_IMG_CF_TRUE_COLOR_ALPHA : LV_IMG_CF_TRUE_COLOR;
+    header->w           = e->w;
+    header->h           = e->h;
+    return LV_RES_OK;
+}
+
+// Both formats are v8's own with 16 bit color, only compressed images need a buffer
+static lv_res_t lvgl_pack_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    (void)decoder;
+    const uint8_t *data;
+    const lvgl_pack_entry_t *e = lvgl_pack_entry(dsc->src, &data);
+    if (e == NULL) {
+        return LV_RES_INV;
+    }
+    if (e->compression == LVGL_PACK_RAW) {
+        dsc->img_data = data;
+        return LV_RES_OK;
+    }
+
+    uint8_t *buf = lvgl_pack_buf_alloc(e->raw_size);
+    if (buf == NULL) {
+        LV_LOG_WARN("lvgl_port_pack: no memory to decode %s", e->name);
+        return LV_RES_INV;
+    }
+    if (!lvgl_pack_lz4(data, e->size, buf, e->raw_size)) {
+        LV_LOG_WARN("lvgl_port_pack: %s is corrupt", e->name);
+        free(buf);
+        return LV_RES_INV;
+    }
+    dsc->img_data  = buf;
+    dsc->user_data = buf;
+    return LV_RES_OK;
+}
+
+static void lvgl_pack_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    (void)decoder;
+    if (dsc->user_data) {
+        free(dsc->user_data);
+        dsc->user_data = NULL;
+    }
+}
+#else
+static lv_result_t lvgl_pack_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc,
+                                  lv_image_header_t *header)
+{
+    (void)decoder;
+    const lvgl_pack_entry_t *e = lvgl_pack_entry(dsc->src, NULL);
+    if (e == NULL) {
+        return LV_RESULT_INVALID;
+    }
+    header->magic  = LV_IMAGE_HEADER_MAGIC;
+    header->cf     = e->format == LVGL_PACK_ARGB8565 ? LV_COLOR_FORMAT_RGB565A8 : LV_COLOR_FORMAT_RGB565;
+    header->flags  = 0;
+    header->w      = e->w;
+    header->h      = e->h;
+    header->stride = e->w * 2;
+    return LV_RESULT_OK;
+}
+
+// v9 keeps alpha in a plane after the colors (RGB565A8), the pack has it next to each pixel
+static void lvgl_pack_split(uint8_t *dst, const uint8_t *src, uint32_t px)
+{
+    uint8_t *alpha = dst + px * 2;
+    for (uint32_t i = 0; i < px; i++) {
+        dst[i * 2]     = src[0];
+        dst[i * 2 + 1] = src[1];
+        alpha[i]       = src[2];
+        src += 3;
+    }
+}
+
+static lv_result_t lvgl_pack_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    const uint8_t *data;
+    const lvgl_pack_entry_t *e = lvgl_pack_entry(dsc->src, &data);
+    if (e == NULL) {
+        return LV_RESULT_INVALID;
+    }
+    const uint32_t stride = e->w * 2;
+    if (e->compression == LVGL_PACK_RAW && e->format == LVGL_PACK_RGB565) {
+        // Drawn straight from the pack, a buffer header around it is all it takes
+        lv_draw_buf_t *buf = (lv_draw_buf_t *)lv_malloc_zeroed(sizeof(lv_draw_buf_t));
+        if (buf == NULL) {
+            return LV_RESULT_INVALID;
+        }
+        lv_draw_buf_init(buf, e->w, e->h, LV_COLOR_FORMAT_RGB565, stride, (void *)data, e->raw_size);
+        dsc->decoded   = buf;
+        dsc->user_data = buf;
+        return LV_RESULT_OK;
+    }
+
+    const lv_color_format_t cf = e->format == LVGL_PACK_ARGB8565 ? LV_COLOR_FORMAT_RGB565A8 : LV_COLOR_FORMAT_RGB565;
+    lv_draw_buf_t *decoded     = lv_draw_buf_create(e->w, e->h, cf, stride);
+    if (decoded == NULL) {
+        return LV_RESULT_INVALID;
+    }
+    bool ok = true;
+    if (e->format == LVGL_PACK_RGB565) {
+        ok = lvgl_pack_lz4(data, e->size, (uint8_t *)decoded->data, e->raw_size);
+    } else {
+        uint8_t *tmp = NULL;
+        if (e->compression == LVGL_PACK_LZ4) {
+            tmp = lvgl_pack_buf_alloc(e->raw_size);
+            ok  = tmp && lvgl_pack_lz4(data, e->size, tmp, e->raw_size);
+        }
+        if (ok) {
+            lvgl_pack_split((uint8_t *)decoded->data, tmp ? tmp : data, (uint32_t)e->w * e->h);
+        }
+        free(tmp);
+    }
+    if (!ok) {
+        LV_LOG_WARN("lvgl_port_pack: %s is corrupt or memory is out", e->name);
+        lv_draw_buf_destroy(decoded);
+        return LV_RESULT_INVALID;
+    }
+    dsc->decoded = decoded;
+
+    if (dsc->args.no_cache || !lv_image_cache_is_enabled()) {
+        return LV_RESULT_OK;
+    }
+    lv_image_cache_data_t search_key;
+    search_key.src_type     = dsc->src_type;
+    search_key.src          = dsc->src;
+    search_key.slot.size    = decoded->data_size;
+    lv_cache_entry_t *entry = lv_image_decoder_add_to_cache(decoder, &search_key, decoded, NULL);
+    if (entry == NULL) {
+        lv_draw_buf_destroy(decoded);
+        return LV_RESULT_INVALID;
+    }
+    dsc->cache_entry = entry;
+    return LV_RESULT_OK;
+}
+
+static void lvgl_pack_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    (void)decoder;
+    if (dsc->user_data) {
+        lv_free(dsc->user_data);  // only the header, the pixels stay in the pack
+        dsc->user_data = NULL;
+    } else if (dsc->args.no_cache || !lv_image_cache_is_enabled()) {
+        lv_draw_buf_destroy((lv_draw_buf_t *)dsc->decoded);
+    }
+}
+#endif
+
+extern "C" bool lvgl_port_pack_add(const void *data, size_t size)
+{
+    const lvgl_pack_header_t *h = (const lvgl_pack_header_t *)data;
+    if (pack_cnt == LV_PORT_PACKS || size < sizeof(*h) || ((uintptr_t)data & 3) || h->magic != LVGL_PACK_MAGIC ||
+        h->version != LVGL_PACK_VERSION || h->size > size ||
+        h->index + (uint64_t)h->count * sizeof(lvgl_pack_entry_t) > h->size) {
+        return false;
+    }
+    const lvgl_pack_entry_t *entries = (const lvgl_pack_entry_t *)((const uint8_t *)data + h->index);
+    for (uint32_t i = 0; i < h->count; i++) {
+        const lvgl_pack_entry_t *e = &entries[i];
+        const uint32_t px_size     = e->format == LVGL_PACK_ARGB8565 ? 3 : 2;
+        if (e->format > LVGL_PACK_ARGB8565 || e->compression > LVGL_PACK_LZ4 || (e->offset & 3) ||
+            e->offset + (uint64_t)e->size > h->size || e->raw_size != (uint32_t)e->w * e->h * px_size ||
+            (e->compression == LVGL_PACK_RAW && e->size != e->raw_size)) {
+            return false;
+        }
+    }
+
+    // Plain calloc, a pack may be added before lv_init()
+    lvgl_pack_t *p = &packs[pack_cnt];
+    p->images      = (decltype(p->images))calloc(h->count ? h->count : 1, sizeof(*p->images));
+    if (p->images == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < h->count; i++) {
+        // Only the decoder reads these, by their address
+#if LVGL_USE_V8 == 1
+        p->images[i].header.cf = LV_IMG_CF_USER_ENCODED_0;
+#else
+        p->images[i].header.magic = LV_IMAGE_HEADER_MAGIC;
+        p->images[i].header.cf    = LV_COLOR_FORMAT_RAW;
+#endif
+        p->images[i].header.w  = entries[i].w;
+        p->images[i].header.h  = entries[i].h;
+        p->images[i].data_size = entries[i].size;
+        p->images[i].data      = (const uint8_t *)data + entries[i].offset;
+    }
+    p->data    = (const uint8_t *)data;
+    p->entries = entries;
+    p->count   = h->count;
+    pack_cnt++;
+    return true;
+}
+
+extern "C" bool lvgl_port_pack_load(const char *path)
+{
+#if !(defined(ARDUINO) && defined(ESP_PLATFORM)) && __has_include(<sys/mman.h>)
+    const int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("ERROR: Cannot open the image pack %s\n", path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays
+    if (data == MAP_FAILED) {
+        printf("ERROR: Cannot map the image pack %s\n", path);
+        return false;
+    }
+    const size_t size = (size_t)st.st_size;
+#else
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("ERROR: Cannot open the image pack %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    const size_t size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+#if defined(ARDUINO) && defined(ESP_PLATFORM) && defined(BOARD_HAS_PSRAM)
+    void *data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#else
+    void *data = malloc(size);
+#endif
+    const bool read = data && fread(data, 1, size, f) == size;
+    fclose(f);
+    if (!read) {
+        printf("ERROR: Cannot read the image pack %s\n", path);
+        free(data);
+        return false;
+    }
+#endif
+    if (!lvgl_port_pack_add(data, size)) {
+        printf("ERROR: %s is not an image pack or too many packs are open\n", path);
+#if !(defined(ARDUINO) && defined(ESP_PLATFORM)) && __has_include(<sys/mman.h>)
+        munmap(data, size);
+#else
+        free(data);
+#endif
+        return false;
+    }
+    return true;
+}
+
+extern "C" const void *lvgl_port_pack_image(const char *name)
+{
+    for (uint32_t i = 0; i < pack_cnt; i++) {
+        const lvgl_pack_t *p = &packs[i];
+        uint32_t lo = 0, hi = p->count;
+        while (lo < hi) {
+            const uint32_t mid = (lo + hi) / 2;
+            const int cmp      = strncmp(name, p->entries[mid].name, LVGL_PACK_NAME_LEN);
+            if (cmp == 0) {
+                return &p->images[mid];
+            }
+            if (cmp < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+    }
+    return NULL;
+}
+
+extern "C" void lvgl_port_pack_start(void)
+{
+    // Added last, so LVGL asks this decoder first
+#if LVGL_USE_V8 == 1
+    lv_img_decoder_t *decoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(decoder, lvgl_pack_info);
+    lv_img_decoder_set_open_cb(decoder, lvgl_pack_open);
+    lv_img_decoder_set_close_cb(decoder, lvgl_pack_close);
+#else
+    lv_image_decoder_t *decoder = lv_image_decoder_create();
+    lv_image_decoder_set_info_cb(decoder, lvgl_pack_info);
+    lv_image_decoder_set_open_cb(decoder, lvgl_pack_open);
+    lv_image_decoder_set_close_cb(decoder, lvgl_pack_close);
+    decoder->name = "PACK";
+#endif
+}
+
+#else
+
+extern "C" bool lvgl_port_pack_add(const void *data, size_t size)
+{
+    (void)data;
+    (void)size;
+    return false;
+}
+
+extern "C" bool lvgl_port_pack_load(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+extern "C" const void *lvgl_port_pack_image(const char *name)
+{
+    (void)name;
+    return NULL;
+}
+
+extern "C" void lvgl_port_pack_start(void)
+{
+}
+
+#endif  // LV_PORT_PACK
@@ -0,0 +1,40 @@
+#ifndef __LVGL_PORT_PACK_HPP__
+#define __LVGL_PORT_PACK_HPP__
+
+#include "lvgl.h"
+
+// 1: image decoder for the packs support/asset_pack.py builds
+#ifndef LV_PORT_PACK
+#define LV_PORT_PACK 1
+#endif
+
+// Packs that can be open at the same time
+#ifndef LV_PORT_PACKS
+#define LV_PORT_PACKS 4
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Adds a pack that is already in memory, e.g. embedded in flash with `board_build.embed_files`. `data` must
+// stay valid and 4 byte aligned. Returns false for a damaged pack or when LV_PORT_PACKS are open
+bool lvgl_port_pack_add(const void *data, size_t size);
+
+// Maps a pack file (mmap on the emulator, read into PSRAM or the heap on the device) and adds it
+bool lvgl_port_pack_load(const char *path);
+
+// Image source for lv_img_set_src() / lv_image_set_src() of the image `name` (its path below the assets
+// directory without extension, or the EEZ Studio bitmap name), NULL if no open pack has it. Decoded RGB565
+// images are drawn straight from the pack, compressed ones are decoded into a buffer LVGL's image cache keeps.
+// Call with the GUI lock held
+const void *lvgl_port_pack_image(const char *name);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_pack_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_PACK_HPP__
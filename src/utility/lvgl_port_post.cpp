@@ -0,0 +1,210 @@
+#include "lvgl_port_post.hpp"
+#include "lvgl_port_m5stack.hpp"
+#include <atomic>
+
+static_assert((LV_PORT_POST_QUEUE_LEN & (LV_PORT_POST_QUEUE_LEN - 1)) == 0, "LV_PORT_POST_QUEUE_LEN: power of two");
+
+typedef struct {
+    std::atomic<uint32_t> seq;  // == position: free for the producer, == position + 1: ready for the consumer
+    lvgl_port_post_cb_t cb;
+    lvgl_port_post_cb_t done;  // run after cb, on the GUI thread
+    void *user_data;
+} lvgl_post_cell_t;
+
+// Bounded queue after Dmitry Vyukov: producers and consumers each claim a position with one compare-exchange
+// and the cell's sequence number hands the payload over, so nobody waits for a thread that got preempted
+// between the two.
+typedef struct {
+    lvgl_post_cell_t cells[LV_PORT_POST_QUEUE_LEN];
+    std::atomic<uint32_t> tail;  // next position to write
+    std::atomic<uint32_t> head;  // next position to read
+} lvgl_post_queue_t;
+
+static lvgl_post_queue_t post_queue;  // closures for the GUI thread
+#if LV_PORT_WORKERS > 0
+static lvgl_post_queue_t work_queue;  // jobs for the workers
+#endif
+
+static void lvgl_post_queue_init(lvgl_post_queue_t *q)
+{
+    for (uint32_t i = 0; i < LV_PORT_POST_QUEUE_LEN; i++) {
+        q->cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    q->tail.store(0, std::memory_order_relaxed);
+    q->head.store(0, std::memory_order_release);
+}
+
+static bool lvgl_post_queue_push(lvgl_post_queue_t *q, lvgl_port_post_cb_t cb, lvgl_port_post_cb_t done,
+                                 void *user_data)
+{
+    uint32_t pos = q->tail.load(std::memory_order_relaxed);
+    lvgl_post_cell_t *cell;
+    while (1) {
+        cell         = &q->cells[pos % LV_PORT_POST_QUEUE_LEN];
+        int32_t diff = (int32_t)(cell->seq.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (q->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // full
+        } else {
+            pos = q->tail.load(std::memory_order_relaxed);
+        }
+    }
+    cell->cb        = cb;
+    cell->done      = done;
+    cell->user_data = user_data;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static bool lvgl_post_queue_pop(lvgl_post_queue_t *q, lvgl_post_cell_t *out)
+{
+    uint32_t pos = q->head.load(std::memory_order_relaxed);
+    lvgl_post_cell_t *cell;
+    while (1) {
+        cell         = &q->cells[pos % LV_PORT_POST_QUEUE_LEN];
+        int32_t diff = (int32_t)(cell->seq.load(std::memory_order_acquire) - (pos + 1));
+        if (diff == 0) {
+            if (q->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // empty
+        } else {
+            pos = q->head.load(std::memory_order_relaxed);
+        }
+    }
+    out->cb        = cell->cb;
+    out->done      = cell->done;
+    out->user_data = cell->user_data;
+    cell->seq.store(pos + LV_PORT_POST_QUEUE_LEN, std::memory_order_release);
+    return true;
+}
+
+#if LV_PORT_WORKERS > 0
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static SemaphoreHandle_t xWorkSemaphore;
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static SDL_sem *xWorkSem;
+#endif
+static std::atomic<bool> workers_started;  // by the first lvgl_port_run_async() call
+
+static void lvgl_port_worker_run(void)
+{
+    lvgl_post_cell_t job;
+    while (lvgl_post_queue_pop(&work_queue, &job)) {
+        job.cb(job.user_data);
+        if (job.done == NULL) {
+            continue;
+        }
+        // The completion must not get lost, wait for the GUI thread to make room
+        while (!lvgl_port_post(job.done, job.user_data)) {
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+            vTaskDelay(1);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+            SDL_Delay(1);
+#endif
+        }
+    }
+}
+
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+static void lvgl_worker_task(void *pvParameter)
+{
+    (void)pvParameter;
+    while (1) {
+        xSemaphoreTake(xWorkSemaphore, portMAX_DELAY);
+        lvgl_port_worker_run();
+    }
+}
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+static int lvgl_worker_thread(void *data)
+{
+    (void)data;
+    while (1) {
+        SDL_SemWait(xWorkSem);
+        lvgl_port_worker_run();
+    }
+    return 0;
+}
+#endif
+
+// Apps that never run work in the background do not pay for the worker stacks
+static void lvgl_port_workers_start(void)
+{
+    if (workers_started.exchange(true)) {
+        return;
+    }
+    for (int i = 0; i < LV_PORT_WORKERS; i++) {
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+        xTaskCreate(lvgl_worker_task, "lvgl_worker", 4096, NULL, 1, NULL);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+        SDL_CreateThread(lvgl_worker_thread, "lvgl_worker", NULL);
+#endif
+    }
+}
+#endif
+
+extern "C" void lvgl_port_post_init(void)
+{
+    lvgl_post_queue_init(&post_queue);
+#if LV_PORT_WORKERS > 0
+    lvgl_post_queue_init(&work_queue);
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    xWorkSemaphore = xSemaphoreCreateCounting(LV_PORT_POST_QUEUE_LEN, 0);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    xWorkSem = SDL_CreateSemaphore(0);
+#endif
+#endif
+}
+
+extern "C" bool lvgl_port_post(lvgl_port_post_cb_t cb, void *user_data)
+{
+    if (!lvgl_post_queue_push(&post_queue, cb, NULL, user_data)) {
+        return false;
+    }
+    lvgl_port_wake();
+    return true;
+}
+
+extern "C" bool lvgl_port_run_async(lvgl_port_post_cb_t work, lvgl_port_post_cb_t done, void *user_data)
+{
+#if LV_PORT_WORKERS > 0
+    lvgl_port_workers_start();
+    if (!lvgl_post_queue_push(&work_queue, work, done, user_data)) {
+        return false;
+    }
+#if defined(ARDUINO) && defined(ESP_PLATFORM)
+    xSemaphoreGive(xWorkSemaphore);
+#elif !defined(ARDUINO) && (__has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>))
+    SDL_SemPost(xWorkSem);
+#endif
+#else
+    if (!lvgl_post_queue_push(&post_queue, work, done, user_data)) {
+        return false;
+    }
+    lvgl_port_wake();
+#endif
+    return true;
+}
+
+extern "C" bool lvgl_port_post_run_one(void)
+{
+    lvgl_post_cell_t c;
+    if (!lvgl_post_queue_pop(&post_queue, &c)) {
+        return false;
+    }
+    c.cb(c.user_data);
+    if (c.done) {
+        c.done(c.user_data);
+    }
+    return true;
+}
+
+extern "C" bool lvgl_port_post_pending(void)
+{
+    uint32_t pos = post_queue.head.load(std::memory_order_relaxed);
+    return post_queue.cells[pos % LV_PORT_POST_QUEUE_LEN].seq.load(std::memory_order_acquire) == pos + 1;
+}
@@ -0,0 +1,40 @@
+#ifndef __LVGL_PORT_POST_HPP__
+#define __LVGL_PORT_POST_HPP__
+
+#include <stdint.h>
+
+// Closures the post queue holds, a power of two
+#ifndef LV_PORT_POST_QUEUE_LEN
+#define LV_PORT_POST_QUEUE_LEN 128
+#endif
+
+// Background worker threads for lvgl_port_run_async(), started by its first call. 0 runs the work on the GUI thread
+#ifndef LV_PORT_WORKERS
+#define LV_PORT_WORKERS 2
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*lvgl_port_post_cb_t)(void *user_data);
+
+// Queues cb to run on the GUI thread with the GUI lock held, before its next lv_timer_handler() call.
+// Any thread after lvgl_port_init(), never blocks. Returns false when the queue is full.
+bool lvgl_port_post(lvgl_port_post_cb_t cb, void *user_data);
+
+// Runs work on a worker thread without the GUI lock, then done (may be NULL) like lvgl_port_post().
+// Any thread after lvgl_port_init(), never blocks. Returns false when the worker queue is full.
+bool lvgl_port_run_async(lvgl_port_post_cb_t work, lvgl_port_post_cb_t done, void *user_data);
+
+// Used by the port
+void lvgl_port_post_init(void);
+// Runs the oldest posted closure, false when there was none. GUI thread with the GUI lock held.
+bool lvgl_port_post_run_one(void);
+bool lvgl_port_post_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_POST_HPP__
@@ -0,0 +1,104 @@
+#include "lvgl_port_rgb565.hpp"
+#include <cstring>  // for memcpy
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LVGL_RGB565_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LVGL_RGB565_NEON 1
+#endif
+
+typedef void (*lvgl_rgb565_swap_fn)(uint16_t *dst, const uint16_t *src, size_t count);
+
+extern "C" void lvgl_port_rgb565_swap_scalar(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    // Two pixels per 32-bit word where possible, the MCUs have no byte swap for halfwords
+    while (count && ((uintptr_t)src & 3)) {
+        uint16_t p = *src++;
+        *dst++     = (uint16_t)((p >> 8) | (p << 8));
+        count--;
+    }
+    if (((uintptr_t)dst & 3) == 0) {
+        for (; count >= 2; count -= 2, src += 2, dst += 2) {
+            uint32_t p;
+            memcpy(&p, src, sizeof(p));
+            p = ((p & 0xFF00FF00u) >> 8) | ((p & 0x00FF00FFu) << 8);
+            memcpy(dst, &p, sizeof(p));
+        }
+    }
+    while (count--) {
+        uint16_t p = *src++;
+        *dst++     = (uint16_t)((p >> 8) | (p << 8));
+    }
+}
+
+#if defined(LVGL_RGB565_X86)
+__attribute__((target("sse2"))) static void lvgl_rgb565_swap_sse2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    for (; count >= 8; count -= 8, src += 8, dst += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        v         = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *)dst, v);
+    }
+    lvgl_port_rgb565_swap_scalar(dst, src, count);
+}
+
+__attribute__((target("avx2"))) static void lvgl_rgb565_swap_avx2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,  //
+                                             1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    for (; count >= 32; count -= 32, src += 32, dst += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)src);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + 16));
+        _mm256_storeu_si256((__m256i *)dst, _mm256_shuffle_epi8(a, shuffle));
+        _mm256_storeu_si256((__m256i *)(dst + 16), _mm256_shuffle_epi8(b, shuffle));
+    }
+    for (; count >= 16; count -= 16, src += 16, dst += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)src);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_shuffle_epi8(a, shuffle));
+    }
+    lvgl_port_rgb565_swap_scalar(dst, src, count);
+}
+#elif defined(LVGL_RGB565_NEON)
+static void lvgl_rgb565_swap_neon(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    for (; count >= 8; count -= 8, src += 8, dst += 8) {
+        vst1q_u8((uint8_t *)dst, vrev16q_u8(vld1q_u8((const uint8_t *)src)));
+    }
+    lvgl_port_rgb565_swap_scalar(dst, src, count);
+}
+#endif
+
+static lvgl_rgb565_swap_fn lvgl_rgb565_select(const char **name)
+{
+#if defined(LVGL_RGB565_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return lvgl_rgb565_swap_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return lvgl_rgb565_swap_sse2;
+    }
+#elif defined(LVGL_RGB565_NEON)
+    *name = "neon";
+    return lvgl_rgb565_swap_neon;
+#endif
+    *name = "scalar";
+    return lvgl_port_rgb565_swap_scalar;
+}
+
+static const char *kernel_name;
+static const lvgl_rgb565_swap_fn kernel = lvgl_rgb565_select(&kernel_name);
+
+extern "C" void lvgl_port_rgb565_swap(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    kernel(dst, src, count);
+}
+
+extern "C" const char *lvgl_port_rgb565_kernel_name(void)
+{
+    return kernel_name;
+}
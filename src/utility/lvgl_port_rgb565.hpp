@@ -0,0 +1,26 @@
+#ifndef __LVGL_PORT_RGB565_HPP__
+#define __LVGL_PORT_RGB565_HPP__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Copies `count` RGB565 pixels from src to dst swapping the two bytes of each pixel, which turns
+// LVGL's native RGB565 into the big endian order the panels (and Panel_sdl) store.
+// dst may be equal to src for an in-place swap, other overlaps are not supported. No alignment is required.
+void lvgl_port_rgb565_swap(uint16_t *dst, const uint16_t *src, size_t count);
+
+// Reference implementation, always available
+void lvgl_port_rgb565_swap_scalar(uint16_t *dst, const uint16_t *src, size_t count);
+
+// Name of the kernel lvgl_port_rgb565_swap() dispatches to ("avx2", "sse2", "neon" or "scalar")
+const char *lvgl_port_rgb565_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_RGB565_HPP__
@@ -0,0 +1,156 @@
+#include "lvgl_port_screenshot.hpp"
+#include <cstdio>   // for fopen, fwrite
+#include <cstdlib>  // for malloc
+#include <cstring>  // for strlen
+#include <strings.h>  // for strcasecmp
+
+#define LVGL_PNG_BLOCK_MAX 65535  // bytes of a stored deflate block
+
+typedef struct {
+    FILE *f;
+    uint32_t crc;     // of the current chunk
+    uint32_t adler_a;  // of the zlib stream
+    uint32_t adler_b;
+} lvgl_png_writer_t;
+
+static uint32_t png_crc_table[256];
+
+static void lvgl_png_crc_init(void)
+{
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        png_crc_table[n] = c;
+    }
+}
+
+static void lvgl_png_write(lvgl_png_writer_t *w, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        w->crc = png_crc_table[(w->crc ^ data[i]) & 0xFF] ^ (w->crc >> 8);
+    }
+    fwrite(data, 1, len, w->f);
+}
+
+static void lvgl_png_write_u32(lvgl_png_writer_t *w, uint32_t v)
+{
+    const uint8_t be[4] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+    lvgl_png_write(w, be, 4);
+}
+
+// Image data that goes through the zlib checksum
+static void lvgl_png_write_data(lvgl_png_writer_t *w, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        w->adler_a = (w->adler_a + data[i]) % 65521;
+        w->adler_b = (w->adler_b + w->adler_a) % 65521;
+    }
+    lvgl_png_write(w, data, len);
+}
+
+static void lvgl_png_chunk_start(lvgl_png_writer_t *w, const char *type, uint32_t len)
+{
+    lvgl_png_write_u32(w, len);  // not part of the CRC
+    w->crc = 0xFFFFFFFFU;
+    lvgl_png_write(w, (const uint8_t *)type, 4);
+}
+
+static void lvgl_png_chunk_end(lvgl_png_writer_t *w)
+{
+    const uint32_t crc = w->crc ^ 0xFFFFFFFFU;
+    lvgl_png_write_u32(w, crc);
+}
+
+// Uncompressed deflate blocks keep the encoder small, screenshots are for tests and bug reports
+static bool lvgl_png_save(FILE *f, const uint16_t *px, int32_t width, int32_t height)
+{
+    const uint32_t row   = 1 + 3 * (uint32_t)width;  // filter byte + RGB
+    const uint32_t raw   = row * (uint32_t)height;
+    const uint32_t count = (raw + LVGL_PNG_BLOCK_MAX - 1) / LVGL_PNG_BLOCK_MAX;
+    uint8_t *line        = (uint8_t *)malloc(row);
+    if (line == NULL) {
+        return false;
+    }
+    lvgl_png_crc_init();
+    lvgl_png_writer_t w = {f, 0, 1, 0};
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+    lvgl_png_chunk_start(&w, "IHDR", 13);
+    lvgl_png_write_u32(&w, width);
+    lvgl_png_write_u32(&w, height);
+    static const uint8_t ihdr[5] = {8, 2, 0, 0, 0};  // 8 bit, RGB, deflate, no filter, no interlace
+    lvgl_png_write(&w, ihdr, sizeof(ihdr));
+    lvgl_png_chunk_end(&w);
+
+    lvgl_png_chunk_start(&w, "IDAT", 2 + count * 5 + raw + 4);
+    static const uint8_t zlib[2] = {0x78, 0x01};
+    lvgl_png_write(&w, zlib, sizeof(zlib));
+    uint32_t left = 0;  // in the current block
+    uint32_t done = 0;
+    for (int32_t y = 0; y < height; y++) {
+        line[0] = 0;
+        for (int32_t x = 0; x < width; x++) {
+            const uint16_t c = *px++;
+            const uint8_t r  = (c >> 11) & 0x1F;
+            const uint8_t g  = (c >> 5) & 0x3F;
+            const uint8_t b  = c & 0x1F;
+            line[1 + 3 * x]  = (uint8_t)(r << 3 | r >> 2);
+            line[2 + 3 * x]  = (uint8_t)(g << 2 | g >> 4);
+            line[3 + 3 * x]  = (uint8_t)(b << 3 | b >> 2);
+        }
+        for (uint32_t i = 0; i < row;) {
+            if (left == 0) {
+                left                 = LV_MIN(raw - done, (uint32_t)LVGL_PNG_BLOCK_MAX);
+                const uint8_t hdr[5] = {(uint8_t)(done + left == raw), (uint8_t)left, (uint8_t)(left >> 8),
+                                        (uint8_t)~left, (uint8_t)(~left >> 8)};
+                lvgl_png_write(&w, hdr, sizeof(hdr));
+            }
+            const uint32_t n = LV_MIN(left, row - i);
+            lvgl_png_write_data(&w, line + i, n);
+            i += n;
+            left -= n;
+            done += n;
+        }
+    }
+    lvgl_png_write_u32(&w, w.adler_b << 16 | w.adler_a);
+    lvgl_png_chunk_end(&w);
+
+    lvgl_png_chunk_start(&w, "IEND", 0);
+    lvgl_png_chunk_end(&w);
+    free(line);
+    return true;
+}
+
+extern "C" bool lvgl_port_screenshot_save(const char *path)
+{
+    int32_t width, height;
+    if (!lvgl_port_screenshot(NULL, 0, &width, &height)) {
+        return false;
+    }
+    const size_t pixels = (size_t)width * height;
+    uint16_t *px        = (uint16_t *)malloc(pixels * sizeof(uint16_t));
+    if (px == NULL || !lvgl_port_screenshot(px, pixels, NULL, NULL)) {
+        free(px);
+        return false;
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        printf("ERROR: Cannot write the screenshot to %s\n", path);
+        free(px);
+        return false;
+    }
+    const size_t len = strlen(path);
+    bool ok;
+    if (len >= 4 && strcasecmp(path + len - 4, ".png") == 0) {
+        ok = lvgl_png_save(f, px, width, height);
+    } else {
+        ok = fwrite(px, sizeof(uint16_t), pixels, f) == pixels;
+    }
+    free(px);
+    ok = !ferror(f) && ok;
+    return (fclose(f) == 0) && ok;
+}
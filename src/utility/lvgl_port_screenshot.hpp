@@ -0,0 +1,18 @@
+#ifndef __LVGL_PORT_SCREENSHOT_HPP__
+#define __LVGL_PORT_SCREENSHOT_HPP__
+
+#include "lvgl_port_m5stack.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writes lvgl_port_screenshot() to `path`: an 8-bit RGB PNG when the name ends in ".png", the RGB565 pixels
+// (little endian, row by row, no header) otherwise. Call with the GUI lock held, false when it could not be written
+bool lvgl_port_screenshot_save(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_SCREENSHOT_HPP__
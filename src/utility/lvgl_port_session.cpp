@@ -0,0 +1,374 @@
+#include "lvgl_port_session.hpp"
+#include "lvgl_port_stats.hpp"
+#include <cstdio>   // for fopen, fprintf
+#include <cstdlib>  // for realloc
+#include <cstring>  // for strcmp
+#include <atomic>
+
+// Session file, little endian: "LVSS", a version byte, then records
+//   'I' len:u8 id[len]                                      names the next widget index
+//   'T' t:u32 x:i16 y:i16 flags:u8 [id:u8 rx:i16 ry:i16]   one touch sample
+// t is in ms since lvgl_port_init(). With LVGL_SESSION_ANCHORED set, rx/ry place the sample in 1/1000 of the
+// area of widget `id`, x/y are only used when that widget does not exist at replay time.
+#define LVGL_SESSION_MAGIC    "LVSS"
+#define LVGL_SESSION_VERSION  1
+#define LVGL_SESSION_ID_MAX   64
+#define LVGL_SESSION_TAIL_MS  1000  // the replay ends this long after its last sample, so the UI can settle
+#define LVGL_SESSION_PRESSED  0x01
+#define LVGL_SESSION_ANCHORED 0x02
+
+typedef struct {
+    lv_obj_t *obj;
+    const char *id;
+} lvgl_session_obj_t;
+
+typedef struct {
+    uint32_t t;
+    int16_t x;
+    int16_t y;
+    uint8_t flags;
+    uint8_t id;
+    int16_t rx;
+    int16_t ry;
+} lvgl_session_sample_t;
+
+static lvgl_port_session_config_t session_config;
+static lvgl_session_obj_t session_objs[LVGL_SESSION_ID_MAX];  // widgets named by the app
+
+static FILE *record_file;
+static uint32_t record_start;
+static const char *record_ids[LVGL_SESSION_ID_MAX];  // ids already in the file, by index
+static uint32_t record_id_cnt;
+static lvgl_session_obj_t record_anchor;  // widget the current press started on
+static lvgl_session_sample_t record_last;
+
+static lvgl_session_sample_t *replay_samples;
+static uint32_t replay_cnt;
+static uint32_t replay_pos;
+static char *replay_ids[LVGL_SESSION_ID_MAX];
+static uint32_t replay_start;
+static bool replay_active;
+static std::atomic<int> replay_exit_code(-1);  // set when a replay with session_config.exit ends
+static lv_point_t replay_point;  // state of the last replayed sample
+static bool replay_pressed;
+
+static lv_obj_t *lvgl_session_screen(void)
+{
+#if LVGL_USE_V8 == 1
+    return lv_scr_act();
+#else
+    return lv_screen_active();
+#endif
+}
+
+static void lvgl_session_obj_deleted(lv_event_t *e)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
+    for (uint32_t i = 0; i < LVGL_SESSION_ID_MAX; i++) {
+        if (session_objs[i].obj == obj) {
+            session_objs[i].obj = NULL;
+        }
+    }
+}
+
+// Named widget obj belongs to, NULL when neither it nor a parent has an id
+static const lvgl_session_obj_t *lvgl_session_named(lv_obj_t *obj)
+{
+    for (; obj; obj = lv_obj_get_parent(obj)) {
+        for (uint32_t i = 0; i < LVGL_SESSION_ID_MAX; i++) {
+            if (session_objs[i].obj == obj) {
+                return &session_objs[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+static lv_obj_t *lvgl_session_find(const char *id)
+{
+    for (uint32_t i = 0; i < LVGL_SESSION_ID_MAX; i++) {
+        if (session_objs[i].obj && strcmp(session_objs[i].id, id) == 0) {
+            return session_objs[i].obj;
+        }
+    }
+    return NULL;
+}
+
+static void lvgl_session_put(uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, record_file);
+    }
+}
+
+static bool lvgl_session_get(FILE *f, uint32_t *value, int bytes)
+{
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = fgetc(f);
+        if (c == EOF) {
+            return false;
+        }
+        *value |= (uint32_t)c << (8 * i);
+    }
+    return true;
+}
+
+// Index of id in the file, written on first use. -1 when the file has no room for more ids
+static int32_t lvgl_session_record_id(const char *id)
+{
+    for (uint32_t i = 0; i < record_id_cnt; i++) {
+        if (strcmp(record_ids[i], id) == 0) {
+            return (int32_t)i;
+        }
+    }
+    if (record_id_cnt == LVGL_SESSION_ID_MAX) {
+        return -1;
+    }
+    const size_t len = LV_MIN(strlen(id), 255);
+    fputc('I', record_file);
+    fputc((int)len, record_file);
+    fwrite(id, 1, len, record_file);
+    record_ids[record_id_cnt] = id;
+    return (int32_t)record_id_cnt++;
+}
+
+static bool lvgl_session_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char magic[4];
+    if (f == NULL || fread(magic, 1, 4, f) != 4 || memcmp(magic, LVGL_SESSION_MAGIC, 4) != 0 ||
+        fgetc(f) != LVGL_SESSION_VERSION) {
+        printf("ERROR: %s is not a session file\n", path);
+        if (f) {
+            fclose(f);
+        }
+        return false;
+    }
+
+    uint32_t capacity = 0;
+    uint32_t id_cnt   = 0;
+    bool ok           = true;
+    int type;
+    while (ok && (type = fgetc(f)) != EOF) {
+        uint32_t v[7] = {0};
+        if (type == 'I') {
+            char *id = NULL;
+            ok = lvgl_session_get(f, &v[0], 1) && (id = (char *)malloc(v[0] + 1)) && fread(id, 1, v[0], f) == v[0];
+            if (ok && id_cnt < LVGL_SESSION_ID_MAX) {
+                id[v[0]]             = '\0';
+                replay_ids[id_cnt++] = id;
+            } else {
+                free(id);
+            }
+            continue;
+        }
+        ok = (type == 'T') && lvgl_session_get(f, &v[0], 4) && lvgl_session_get(f, &v[1], 2) &&
+             lvgl_session_get(f, &v[2], 2) && lvgl_session_get(f, &v[3], 1);
+        if (ok && (v[3] & LVGL_SESSION_ANCHORED)) {
+            ok = lvgl_session_get(f, &v[4], 1) && lvgl_session_get(f, &v[5], 2) && lvgl_session_get(f, &v[6], 2) &&
+                 v[4] < id_cnt;
+        }
+        if (ok && replay_cnt == capacity) {
+            capacity                   = capacity ? capacity * 2 : 256;
+            lvgl_session_sample_t *arr = (lvgl_session_sample_t *)realloc(replay_samples, capacity * sizeof(*arr));
+            ok                         = (arr != NULL);
+            replay_samples             = ok ? arr : replay_samples;
+        }
+        if (ok) {
+            lvgl_session_sample_t *s = &replay_samples[replay_cnt++];
+            s->t                     = v[0];
+            s->x                     = (int16_t)v[1];
+            s->y                     = (int16_t)v[2];
+            s->flags                 = (uint8_t)v[3];
+            s->id                    = (uint8_t)v[4];
+            s->rx                    = (int16_t)v[5];
+            s->ry                    = (int16_t)v[6];
+        }
+    }
+    fclose(f);
+    if (!ok) {
+        printf("ERROR: %s is truncated or corrupt\n", path);
+    }
+    return ok;
+}
+
+static void lvgl_session_write_stats(const char *path, uint32_t duration_ms)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        printf("ERROR: Cannot write replay statistics to %s\n", path);
+        return;
+    }
+    lvgl_port_stats_t stats;
+    lvgl_port_get_stats(&stats);
+    fprintf(f, "{\n  \"replay\": \"%s\", \"samples\": %u, \"duration_ms\": %u,\n  \"stats\": {", session_config.replay,
+            (unsigned)replay_cnt, (unsigned)duration_ms);
+    for (int i = 0; i < LVGL_PORT_STAT_COUNT; i++) {
+        const lvgl_port_stat_t *s = &stats.stat[i];
+        fprintf(f, "%s\n    \"%s\": {\"count\": %u, \"mean\": %u, \"p50\": %u, \"p95\": %u, \"p99\": %u, \"max\": %u}",
+                i ? "," : "", lvgl_port_stat_name((lvgl_port_stat_id_t)i), (unsigned)s->count, (unsigned)s->mean,
+                (unsigned)s->p50, (unsigned)s->p95, (unsigned)s->p99, (unsigned)s->max);
+    }
+    fprintf(f, "\n  }\n}\n");
+    fclose(f);
+}
+
+extern "C" void lvgl_port_session_request(const lvgl_port_session_config_t *config)
+{
+    session_config = *config;
+}
+
+extern "C" bool lvgl_port_replay_active(void)
+{
+    return replay_active;
+}
+
+extern "C" void lvgl_port_obj_set_id(lv_obj_t *obj, const char *id)
+{
+    lvgl_session_obj_t *slot = NULL;
+    for (uint32_t i = 0; i < LVGL_SESSION_ID_MAX; i++) {
+        if (session_objs[i].obj == obj) {
+            slot = &session_objs[i];
+            break;
+        }
+        if (slot == NULL && session_objs[i].obj == NULL) {
+            slot = &session_objs[i];
+        }
+    }
+    if (slot == NULL) {
+        LV_LOG_WARN("lvgl_port_obj_set_id: more than %d named widgets", LVGL_SESSION_ID_MAX);
+        return;
+    }
+    if (slot->obj != obj) {
+        lv_obj_add_event_cb(obj, lvgl_session_obj_deleted, LV_EVENT_DELETE, NULL);
+    }
+    slot->obj = obj;
+    slot->id  = id;
+}
+
+extern "C" void lvgl_port_session_start(void)
+{
+    const uint32_t now = lv_tick_get();
+    if (session_config.record) {
+        record_file = fopen(session_config.record, "wb");
+        if (record_file == NULL) {
+            printf("ERROR: Cannot record the session to %s\n", session_config.record);
+        } else {
+            fwrite(LVGL_SESSION_MAGIC, 1, 4, record_file);
+            fputc(LVGL_SESSION_VERSION, record_file);
+            record_start = now;
+        }
+    }
+    if (session_config.replay && lvgl_session_load(session_config.replay)) {
+        replay_active = true;
+        replay_start  = now;
+        lvgl_port_reset_stats();
+    } else if (session_config.replay && session_config.exit) {
+        replay_exit_code = 1;
+    }
+}
+
+extern "C" void lvgl_port_record_sample(uint32_t tick, const lv_point_t *point, bool pressed)
+{
+    if (record_file == NULL) {
+        return;
+    }
+    if (pressed == (bool)(record_last.flags & LVGL_SESSION_PRESSED) &&
+        (!pressed || (point->x == record_last.x && point->y == record_last.y))) {
+        return;  // only changes are stored
+    }
+
+    lvgl_session_sample_t s = {};
+    s.t                     = tick - record_start;
+    s.x                     = (int16_t)point->x;
+    s.y                     = (int16_t)point->y;
+    s.flags                 = pressed ? LVGL_SESSION_PRESSED : 0;
+    if (pressed && !(record_last.flags & LVGL_SESSION_PRESSED)) {
+        // A gesture stays anchored to the widget it started on
+        lv_point_t p                    = *point;
+        const lvgl_session_obj_t *named = lvgl_session_named(lv_indev_search_obj(lvgl_session_screen(), &p));
+        record_anchor.obj               = named ? named->obj : NULL;
+        record_anchor.id                = named ? named->id : NULL;
+    }
+    const int32_t id = (record_anchor.obj && lvgl_session_find(record_anchor.id) == record_anchor.obj)
+                           ? lvgl_session_record_id(record_anchor.id)
+                           : -1;
+    if (id >= 0) {
+        lv_area_t a;
+        lv_obj_get_coords(record_anchor.obj, &a);
+        s.flags |= LVGL_SESSION_ANCHORED;
+        s.id = (uint8_t)id;
+        s.rx = (int16_t)((point->x - a.x1) * 1000 / LV_MAX(lv_area_get_width(&a), 1));
+        s.ry = (int16_t)((point->y - a.y1) * 1000 / LV_MAX(lv_area_get_height(&a), 1));
+    }
+
+    fputc('T', record_file);
+    lvgl_session_put(s.t, 4);
+    lvgl_session_put((uint16_t)s.x, 2);
+    lvgl_session_put((uint16_t)s.y, 2);
+    lvgl_session_put(s.flags, 1);
+    if (s.flags & LVGL_SESSION_ANCHORED) {
+        lvgl_session_put(s.id, 1);
+        lvgl_session_put((uint16_t)s.rx, 2);
+        lvgl_session_put((uint16_t)s.ry, 2);
+    }
+    if (!pressed) {
+        record_anchor.obj = NULL;
+        fflush(record_file);  // a session ends whenever the emulator is closed
+    }
+    record_last = s;
+}
+
+extern "C" bool lvgl_port_replay_read(uint32_t tick, lv_point_t *point, bool *pressed, uint32_t *sample_tick)
+{
+    if (replay_pos < replay_cnt && (int32_t)(tick - replay_start - replay_samples[replay_pos].t) >= 0) {
+        const lvgl_session_sample_t *s = &replay_samples[replay_pos++];
+        lv_obj_t *anchor = (s->flags & LVGL_SESSION_ANCHORED) ? lvgl_session_find(replay_ids[s->id]) : NULL;
+        if (anchor) {
+            lv_area_t a;
+            lv_obj_get_coords(anchor, &a);
+            replay_point.x = a.x1 + s->rx * lv_area_get_width(&a) / 1000;
+            replay_point.y = a.y1 + s->ry * lv_area_get_height(&a) / 1000;
+        } else {
+            replay_point.x = s->x;
+            replay_point.y = s->y;
+        }
+        replay_pressed = (s->flags & LVGL_SESSION_PRESSED) != 0;
+        *sample_tick   = replay_start + s->t;
+    }
+    *point   = replay_point;
+    *pressed = replay_pressed;
+    return replay_pos < replay_cnt && (int32_t)(tick - replay_start - replay_samples[replay_pos].t) >= 0;
+}
+
+extern "C" uint32_t lvgl_port_replay_step(uint32_t tick)
+{
+    if (!replay_active) {
+        return LV_NO_TIMER_READY;
+    }
+    const uint32_t elapsed = tick - replay_start;
+    if (replay_pos < replay_cnt) {
+        const uint32_t t = replay_samples[replay_pos].t;
+        return t > elapsed ? t - elapsed : 0;
+    }
+    const uint32_t end = (replay_cnt ? replay_samples[replay_cnt - 1].t : 0) + LVGL_SESSION_TAIL_MS;
+    if (elapsed < end) {
+        return end - elapsed;
+    }
+
+    replay_active = false;
+    printf("replay: %u samples in %u ms\n", (unsigned)replay_cnt, (unsigned)elapsed);
+    if (session_config.stats) {
+        lvgl_session_write_stats(session_config.stats, elapsed);
+    }
+    if (session_config.exit) {
+        replay_exit_code = 0;
+    }
+    return LV_NO_TIMER_READY;
+}
+
+extern "C" int lvgl_port_replay_exit_code(void)
+{
+    return replay_exit_code;
+}
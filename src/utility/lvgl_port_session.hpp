@@ -0,0 +1,41 @@
+#ifndef __LVGL_PORT_SESSION_HPP__
+#define __LVGL_PORT_SESSION_HPP__
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *record;  // session file to write the touch input to, NULL: no recording
+    const char *replay;  // session file to play instead of the touch panel, NULL: no replay
+    const char *stats;   // JSON file for the frame statistics once the replay is over, NULL: none
+    bool exit;           // quit the emulator once the replay is over, see lvgl_port_replay_exit_code()
+} lvgl_port_session_config_t;
+
+// Call before lvgl_port_init(), sdl_main.cpp does for --record / --replay <file>. Sessions are timed from
+// lvgl_port_init() in LVGL ticks, so a replay on the virtual clock (LV_PORT_VIRTUAL_CLOCK) repeats exactly.
+void lvgl_port_session_request(const lvgl_port_session_config_t *config);
+bool lvgl_port_replay_active(void);
+// With `exit` set: 0 once the replay is over, 1 when the session could not be loaded, -1 until then.
+// Any thread, sdl_main.cpp then stops the port and quits instead of running the app on
+int lvgl_port_replay_exit_code(void);
+
+// Names obj for recordings: touches on it or its children are stored relative to its area and replayed on
+// wherever it is then, so sessions survive layout changes. `id` must outlive obj. Call with the GUI lock held
+void lvgl_port_obj_set_id(lv_obj_t *obj, const char *id);
+
+// Used by the port, GUI thread with the GUI lock held
+void lvgl_port_session_start(void);
+void lvgl_port_record_sample(uint32_t tick, const lv_point_t *point, bool pressed);
+// Takes the next replayed sample due at tick, returns false when none is due (the last state stays)
+bool lvgl_port_replay_read(uint32_t tick, lv_point_t *point, bool *pressed, uint32_t *sample_tick);
+// ms until the next replayed sample is due (0: now), LV_NO_TIMER_READY without one. Ends the replay after the last.
+uint32_t lvgl_port_replay_step(uint32_t tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_SESSION_HPP__
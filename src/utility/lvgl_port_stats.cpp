@@ -0,0 +1,91 @@
+#include "lvgl_port_stats.hpp"
+#include <algorithm>  // for std::sort
+#include <atomic>
+#include <cstring>  // for memset
+
+extern "C" void lvgl_port_stats_summarize(uint32_t *values, uint32_t n, lvgl_port_stat_t *stat)
+{
+    stat->count = n;
+    if (n == 0) {
+        stat->mean = stat->p50 = stat->p95 = stat->p99 = stat->max = 0;
+        return;
+    }
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += values[i];
+    }
+    std::sort(values, values + n);
+    stat->mean = (uint32_t)(sum / n);
+    stat->p50  = values[(n - 1) * 50 / 100];
+    stat->p95  = values[(n - 1) * 95 / 100];
+    stat->p99  = values[(n - 1) * 99 / 100];
+    stat->max  = values[n - 1];
+}
+
+#if LV_PORT_STATS
+// Latest samples of one metric. Writers claim a slot with one atomic add, readers copy the window
+// without stopping them, so a snapshot taken during a write may hold one stale slot at most.
+typedef struct {
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> values[LVGL_PORT_STATS_WINDOW];
+} lvgl_stats_ring_t;
+
+static lvgl_stats_ring_t stats_rings[LVGL_PORT_STAT_COUNT];
+
+extern "C" void lvgl_port_stats_record(lvgl_port_stat_id_t id, uint32_t value)
+{
+    lvgl_stats_ring_t *ring = &stats_rings[id];
+    uint32_t slot           = ring->head.fetch_add(1, std::memory_order_relaxed) % LVGL_PORT_STATS_WINDOW;
+    ring->values[slot].store(value, std::memory_order_release);
+}
+
+static void lvgl_stats_summarize(lvgl_stats_ring_t *ring, lvgl_port_stat_t *stat)
+{
+    uint32_t values[LVGL_PORT_STATS_WINDOW];
+    const uint32_t head = ring->head.load(std::memory_order_acquire);
+    const uint32_t n    = head < LVGL_PORT_STATS_WINDOW ? head : LVGL_PORT_STATS_WINDOW;
+
+    for (uint32_t i = 0; i < n; i++) {
+        values[i] = ring->values[i].load(std::memory_order_acquire);
+    }
+    lvgl_port_stats_summarize(values, n, stat);
+    stat->count = head;
+}
+
+extern "C" void lvgl_port_get_stats(lvgl_port_stats_t *stats)
+{
+    for (int i = 0; i < LVGL_PORT_STAT_COUNT; i++) {
+        lvgl_stats_summarize(&stats_rings[i], &stats->stat[i]);
+    }
+}
+
+extern "C" void lvgl_port_reset_stats(void)
+{
+    for (int i = 0; i < LVGL_PORT_STAT_COUNT; i++) {
+        stats_rings[i].head.store(0, std::memory_order_release);
+    }
+}
+#else
+extern "C" void lvgl_port_stats_record(lvgl_port_stat_id_t id, uint32_t value)
+{
+    (void)id;
+    (void)value;
+}
+
+extern "C" void lvgl_port_get_stats(lvgl_port_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+extern "C" void lvgl_port_reset_stats(void)
+{
+}
+#endif
+
+extern "C" const char *lvgl_port_stat_name(lvgl_port_stat_id_t id)
+{
+    static const char *const names[LVGL_PORT_STAT_COUNT] = {
+        "render_us", "flush_us", "frame_us", "pixels", "areas", "lock_wait_us", "timer_handler_us", "lock_hold_us",
+    };
+    return (id >= 0 && id < LVGL_PORT_STAT_COUNT) ? names[id] : "?";
+}
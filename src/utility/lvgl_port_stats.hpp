@@ -0,0 +1,62 @@
+#ifndef __LVGL_PORT_STATS_HPP__
+#define __LVGL_PORT_STATS_HPP__
+
+#include <stdint.h>
+
+// 1: record frame, flush, lock and lv_timer_handler() statistics (about 8 KB of sample rings)
+#ifndef LV_PORT_STATS
+#if defined(ARDUINO)
+#define LV_PORT_STATS 0
+#else
+#define LV_PORT_STATS 1
+#endif
+#endif
+
+// Percentiles are taken over this many of the latest samples of each metric
+#define LVGL_PORT_STATS_WINDOW 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LVGL_PORT_STAT_RENDER_US = 0,     // LVGL rendering time of a frame
+    LVGL_PORT_STAT_FLUSH_US,          // transfer time of a frame
+    LVGL_PORT_STAT_FRAME_US,          // render start to the end of the last transfer
+    LVGL_PORT_STAT_PIXELS,            // pixels flushed per frame
+    LVGL_PORT_STAT_AREAS,             // areas flushed per frame
+    LVGL_PORT_STAT_LOCK_WAIT_US,      // waiting for the GUI lock, GUI thread and lvgl_port_lock() callers
+    LVGL_PORT_STAT_TIMER_HANDLER_US,  // one lv_timer_handler() call
+    LVGL_PORT_STAT_LOCK_HOLD_US,      // holding the GUI lock, GUI thread included
+    LVGL_PORT_STAT_COUNT,
+} lvgl_port_stat_id_t;
+
+typedef struct {
+    uint32_t count;  // samples recorded since start or the last reset
+    uint32_t mean;   // the rest is over the last LVGL_PORT_STATS_WINDOW samples
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+} lvgl_port_stat_t;
+
+typedef struct {
+    lvgl_port_stat_t stat[LVGL_PORT_STAT_COUNT];  // indexed by lvgl_port_stat_id_t
+} lvgl_port_stats_t;
+
+// Snapshot of all metrics. Any thread, the GUI lock is not needed and recording is never blocked.
+void lvgl_port_get_stats(lvgl_port_stats_t *stats);
+void lvgl_port_reset_stats(void);
+const char *lvgl_port_stat_name(lvgl_port_stat_id_t id);
+
+// Used by the port, safe from any thread
+void lvgl_port_stats_record(lvgl_port_stat_id_t id, uint32_t value);
+
+// Mean, percentiles and max of `n` samples, sorts `values` in place. Available without LV_PORT_STATS
+void lvgl_port_stats_summarize(uint32_t *values, uint32_t n, lvgl_port_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_STATS_HPP__
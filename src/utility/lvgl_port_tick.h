@@ -0,0 +1,20 @@
+#ifndef __LVGL_PORT_TICK_H__
+#define __LVGL_PORT_TICK_H__
+
+// Plain C so lv_conf.h can hand it to LVGL as the tick source (LV_TICK_CUSTOM_INCLUDE in v8)
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LVGL's time base [ms]. The monotonic clock, or with LV_PORT_VIRTUAL_CLOCK a clock that only moves
+// when the GUI thread steps to the next LVGL timer.
+uint32_t lvgl_port_tick_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __LVGL_PORT_TICK_H__
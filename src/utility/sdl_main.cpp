@@ -1,23 +1,148 @@
 #include <M5GFX.h>
 #if defined(SDL_h_)
+#include <cstdlib>
+#include <cstring>
+#include "lvgl_port_bench.hpp"
+#include "lvgl_port_golden.hpp"
+#include "lvgl_port_latency.hpp"
 
 void setup(void);
 void loop(void);
 
+// Exit code of a run that ends on its own (replay, benchmark, golden scenes, latency), -1 until then
+static int run_exit_code = -1;
+
+// The harnesses bring the port up on a display of their own instead of the app's setup(), so the app's UI stays
+// out of the measurements
+static int run_harness(void)
+{
+    static M5GFX gfx;
+    gfx.init();
+    lvgl_port_init(gfx);
+    bool ok = false;
+    if (lvgl_port_bench_requested()) {
+        if (lvgl_port_lock()) {
+            ok = lvgl_port_bench_run();
+            lvgl_port_unlock();
+        }
+    } else if (lvgl_port_golden_requested()) {
+        if (lvgl_port_lock()) {
+            ok = lvgl_port_golden_run();
+            lvgl_port_unlock();
+        }
+    } else {
+        ok = lvgl_port_latency_run();  // touches go through the GUI thread, so the lock is not held here
+    }
+    return ok ? 0 : 1;
+}
+
 __attribute__((weak)) int user_func(bool *running)
 {
-    setup();
-    do {
-        loop();
-    } while (*running);
-    return 0;
+    int code;
+    if (lvgl_port_bench_requested() || lvgl_port_golden_requested() || lvgl_port_latency_requested()) {
+        code = run_harness();
+    } else {
+        setup();
+        do {
+            loop();
+            code = lvgl_port_replay_exit_code();
+        } while (*running && code < 0);
+        if (code < 0) {
+            return 0;
+        }
+    }
+    // The run is over: stop the port's threads, then let Panel_sdl close the window and quit SDL
+    run_exit_code = code;
+    lvgl_port_stop();
+    if (!lvgl_port_is_headless()) {
+        SDL_Event quit = {};
+        quit.type      = SDL_QUIT;
+        SDL_PushEvent(&quit);
+    }
+    return code;
 }
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
+    const char *env = getenv("LV_PORT_HEADLESS");
+    if (env && atoi(env)) {
+        lvgl_port_set_headless(true);
+    }
+    // --bench <file> [--bench-warmup N] [--bench-frames N] [--bench-samples N], see support/benchmark.py
+    lvgl_port_bench_config_t bench = {};
+    // --latency <file> [--latency-trials N] touches widgets headless and reports touch-to-photon latency
+    lvgl_port_latency_config_t latency = {};
+    // --record <file> / --replay <file> [--replay-stats <file>] [--replay-exit] touch sessions
+    lvgl_port_session_config_t session = {};
+    // --heap-csv <file> appends a heap usage sample to the file every LV_PORT_HEAP_SAMPLE_MS
+    const char *heap_csv = NULL;
+    // --golden <dir> writes a screenshot of every golden scene, see support/golden.py
+    lvgl_port_golden_config_t golden = {};
+    // --render-mode partial|direct|full overrides LV_PORT_RENDER_MODE
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = (i + 1 < argc);
+        if (strcmp(argv[i], "--headless") == 0) {
+            lvgl_port_set_headless(true);
+        } else if (strcmp(argv[i], "--bench") == 0 && has_value) {
+            bench.output = argv[++i];
+        } else if (strcmp(argv[i], "--bench-warmup") == 0 && has_value) {
+            bench.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-frames") == 0 && has_value) {
+            bench.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-samples") == 0 && has_value) {
+            bench.samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0 && has_value) {
+            latency.output = argv[++i];
+        } else if (strcmp(argv[i], "--latency-trials") == 0 && has_value) {
+            latency.trials = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && has_value) {
+            session.record = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && has_value) {
+            session.replay = argv[++i];
+        } else if (strcmp(argv[i], "--replay-stats") == 0 && has_value) {
+            session.stats = argv[++i];
+            session.exit  = true;
+        } else if (strcmp(argv[i], "--replay-exit") == 0) {
+            session.exit = true;
+        } else if (strcmp(argv[i], "--heap-csv") == 0 && has_value) {
+            heap_csv = argv[++i];
+        } else if (strcmp(argv[i], "--golden") == 0 && has_value) {
+            golden.output = argv[++i];
+        } else if (strcmp(argv[i], "--render-mode") == 0 && has_value) {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "direct") == 0) {
+                lvgl_port_set_render_mode(LVGL_PORT_RENDER_DIRECT);
+            } else if (strcmp(mode, "full") == 0) {
+                lvgl_port_set_render_mode(LVGL_PORT_RENDER_FULL);
+            } else {
+                lvgl_port_set_render_mode(LVGL_PORT_RENDER_PARTIAL);
+            }
+        }
+    }
+    if (bench.output) {
+        lvgl_port_bench_request(&bench);
+    }
+    lvgl_port_session_request(&session);
+    if (heap_csv) {
+        lvgl_port_heap_request_csv(heap_csv);
+    }
+    if (golden.output) {
+        lvgl_port_golden_request(&golden);
+    }
+    if (latency.output) {
+        lvgl_port_set_headless(true);  // touches are injected where the SDL event pump would feed the input queue
+        lvgl_port_latency_request(&latency);
+    }
+    if (lvgl_port_is_headless()) {
+        // No window and no event pump, the app runs on this thread
+        bool running = true;
+        return user_func(&running);
+    }
+
     // The second argument is effective for step execution with breakpoints.
     // You can specify the time in milliseconds to perform slow execution that ensures screen updates.
-    return lgfx::Panel_sdl::main(user_func, 128);
+    const int ret = lgfx::Panel_sdl::main(user_func, 128);
+    return run_exit_code >= 0 ? run_exit_code : ret;
 }
 
 #endif
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""
+Image pack builder for the port's pack decoder (lvgl_port_pack.hpp)
+
+Converts PNG/JPG images, and the bitmaps embedded in EEZ Studio projects (*.eez-project), into one pack file
+of native images: RGB565 for opaque images, ARGB8565 (RGB565 followed by 8 bit alpha per pixel) for the rest.
+Images are LZ4 compressed where that saves at least an eighth, the others are stored as they are and drawn
+straight from the mapped pack. The index at the start of the pack is sorted by name.
+
+    python3 support/asset_pack.py assets -o data/assets.lvpk
+    python3 support/asset_pack.py assets ui/my_ui.eez-project -o data/assets.lvpk
+
+As a PlatformIO extra_script (pre:support/asset_pack.py) it packs the `custom_assets` directory of the project
+(default `assets`) into `custom_assets_pack` (default `data/assets.lvpk`) before the build when any input
+changed, and does nothing when the directory does not exist.
+
+Pack layout, little endian:
+    header  "LVPK", u16 version, u16 count, u32 index offset, u32 file size
+    index   count x {char name[32], u16 w, u16 h, u8 format, u8 compression, u16 flags,
+                     u32 data offset, u32 data size, u32 decoded size}
+    data    4 byte aligned
+"""
+
+import argparse
+import base64
+import io
+import json
+import os
+import struct
+import sys
+
+PACK_MAGIC = b"LVPK"
+PACK_VERSION = 1
+NAME_LEN = 32
+FORMAT_RGB565 = 0
+FORMAT_ARGB8565 = 1
+COMPRESSION_NONE = 0
+COMPRESSION_LZ4 = 1
+IMAGE_EXTS = (".png", ".jpg", ".jpeg")
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct(f"<{NAME_LEN}sHHBBHIII")
+
+
+def lz4_compress(data):
+    """LZ4 block format, greedy matching. Decoded by lvgl_pack_lz4() in lvgl_port_pack.cpp"""
+    n = len(data)
+    out = bytearray()
+
+    def length(v):
+        while v >= 255:
+            out.append(255)
+            v -= 255
+        out.append(v)
+
+    def sequence(literals, offset=0, match=0):
+        ml = match - 4 if offset else 0
+        out.append(min(len(literals), 15) << 4 | min(ml, 15))
+        if len(literals) >= 15:
+            length(len(literals) - 15)
+        out.extend(literals)
+        if offset:
+            out.extend(struct.pack("<H", offset))
+            if ml >= 15:
+                length(ml - 15)
+
+    # The format wants the last match to start 12 bytes and end 5 bytes before the end
+    table = {}
+    anchor = i = 0
+    while i < n - 12:
+        key = data[i:i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > 65535:
+            i += 1
+            continue
+        m = 4
+        end = n - 5 - i
+        while m < end and data[cand + m] == data[i + m]:
+            m += 1
+        sequence(data[anchor:i], i - cand, m)
+        i += m
+        anchor = i
+        if i - 2 >= 0 and i < n - 12:
+            table[data[i - 2:i + 2]] = i - 2
+    sequence(data[anchor:])
+    return bytes(out)
+
+
+def rgb565(r, g, b):
+    return (r >> 3) << 11 | (g >> 2) << 5 | b >> 3
+
+
+def convert(img):
+    """Native pixels of a PIL image: (format, bytes)"""
+    img = img.convert("RGBA")
+    px = img.tobytes()
+    alpha = any(px[i] != 255 for i in range(3, len(px), 4))
+    out = bytearray()
+    if not alpha:
+        for i in range(0, len(px), 4):
+            out.extend(struct.pack("<H", rgb565(px[i], px[i + 1], px[i + 2])))
+        return FORMAT_RGB565, bytes(out)
+
+    # LVGL blends 565 images with straight alpha, a transparent pixel only gets its color cleared so it
+    # compresses like premultiplied data
+    for i in range(0, len(px), 4):
+        a = px[i + 3]
+        c = rgb565(px[i], px[i + 1], px[i + 2]) if a else 0
+        out.extend(struct.pack("<HB", c, a))
+    return FORMAT_ARGB8565, bytes(out)
+
+
+def load_images(inputs):
+    """(name, PIL image) of every image file below the inputs and every bitmap of the EEZ projects"""
+    from PIL import Image
+
+    images = []
+    for path in inputs:
+        if path.endswith(".eez-project"):
+            with open(path) as f:
+                project = json.load(f)
+            for bitmap in project.get("bitmaps", []):
+                data = bitmap.get("image", "")
+                if not data.startswith("data:image/"):
+                    continue
+                raw = base64.b64decode(data.split(",", 1)[1])
+                images.append((bitmap["name"], Image.open(io.BytesIO(raw))))
+        elif os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                for file in sorted(files):
+                    if file.lower().endswith(IMAGE_EXTS):
+                        full = os.path.join(root, file)
+                        name = os.path.splitext(os.path.relpath(full, path))[0].replace(os.sep, "/")
+                        images.append((name, Image.open(full)))
+        else:
+            images.append((os.path.splitext(os.path.basename(path))[0], Image.open(path)))
+    return images
+
+
+def build_pack(images):
+    images = sorted(images, key=lambda item: item[0].encode())
+    names = [name for name, _ in images]
+    for name in names:
+        if len(name.encode()) >= NAME_LEN:
+            raise ValueError(f"image name longer than {NAME_LEN - 1} bytes: {name}")
+    dup = {name for name in names if names.count(name) > 1}
+    if dup:
+        raise ValueError("duplicate image names: " + ", ".join(sorted(dup)))
+
+    offset = HEADER.size + ENTRY.size * len(images)
+    index = bytearray()
+    data = bytearray()
+    for name, img in images:
+        fmt, px = convert(img)
+        packed = lz4_compress(px)
+        compression = COMPRESSION_LZ4 if len(packed) <= len(px) - len(px) // 8 else COMPRESSION_NONE
+        stored = packed if compression == COMPRESSION_LZ4 else px
+        pad = -(offset + len(data)) % 4
+        data.extend(b"\0" * pad)
+        index.extend(ENTRY.pack(name.encode(), img.width, img.height, fmt, compression, 0, offset + len(data),
+                                len(stored), len(px)))
+        data.extend(stored)
+        print(f"  {name}: {img.width}x{img.height} {'ARGB8565' if fmt else 'RGB565'}, "
+              f"{len(px)} -> {len(stored)} bytes")
+    size = offset + len(data)
+    return HEADER.pack(PACK_MAGIC, PACK_VERSION, len(images), HEADER.size, size) + bytes(index) + bytes(data)
+
+
+def write_pack(inputs, out):
+    pack = build_pack(load_images(inputs))
+    os.makedirs(os.path.dirname(os.path.abspath(out)), exist_ok=True)
+    with open(out, "wb") as f:
+        f.write(pack)
+    print(f"Image pack written to {out} ({len(pack)} bytes)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="image files, directories of images, *.eez-project files")
+    parser.add_argument("-o", "--out", default="data/assets.lvpk", help="pack file")
+    args = parser.parse_args()
+    try:
+        write_pack(args.inputs, args.out)
+    except (OSError, ValueError) as e:
+        print("ERROR:", e)
+        return 1
+    return 0
+
+
+def platformio_step(env):
+    project = env.subst("$PROJECT_DIR")
+    assets = os.path.join(project, env.GetProjectOption("custom_assets", "assets"))
+    out = os.path.join(project, env.GetProjectOption("custom_assets_pack", "data/assets.lvpk"))
+    if not os.path.isdir(assets):
+        return
+
+    inputs = [os.path.join(project, "support", "asset_pack.py")]  # SCons runs the script without __file__
+    for root, _, files in os.walk(assets):
+        inputs += [os.path.join(root, f) for f in files if f.lower().endswith(IMAGE_EXTS + (".eez-project",))]
+    if os.path.exists(out) and os.path.getmtime(out) >= max(os.path.getmtime(f) for f in inputs):
+        return
+
+    try:
+        import PIL  # noqa: F401
+    except ImportError:
+        env.Execute("$PYTHONEXE -m pip install pillow")
+    projects = [f for f in inputs[1:] if f.endswith(".eez-project")]
+    write_pack([assets] + projects, out)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+else:
+    try:
+        Import  # noqa: F821, PlatformIO runs extra_scripts with SCons' Import()
+    except NameError:
+        pass
+    else:
+        Import("env")  # noqa: F821
+        platformio_step(env)  # noqa: F821
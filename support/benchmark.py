@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+Cross-board benchmark runner for the emulator
+
+Builds every emulator board for LVGL v8 and/or v9, runs the port's benchmark scenes headless
+(--headless --bench) and collects render time, flush time and FPS per scene into JSON and CSV.
+With --baseline the run fails when a scene got slower than the stored results by more than
+--threshold percent and more than --sigma standard deviations.
+With --draw-units the v9 builds are repeated with that many software draw units (LV_PORT_DRAW_UNITS)
+and the FPS of each scene is printed relative to one draw unit.
+
+    python3 support/benchmark.py --out bench
+    python3 support/benchmark.py --boards Core Tab5 --lvgl v9 --baseline bench/baseline.json
+    python3 support/benchmark.py --out bench --update-baseline bench/baseline.json
+    python3 support/benchmark.py --boards Tab5 --lvgl v9 --draw-units 1 2 4
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+
+BOARDS = ["Core", "Core2", "CoreS3", "StickCPlus", "StickCPlus2", "Dial", "Tab5"]
+LVGL_VERSIONS = ["v8", "v9"]
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def project_conf(lvgl, units=1):
+    """platformio.ini as it is for v8, a copy switched to LVGL master with its own build dirs for v9"""
+    conf = os.path.join(PROJECT_DIR, "platformio.ini")
+    if lvgl == "v8":
+        return conf, os.path.join(PROJECT_DIR, ".pio", "build")
+
+    name = "v9" if units == 1 else f"v9_units{units}"
+
+    with open(conf) as f:
+        text = f.read()
+    text = re.sub(r"-D LVGL_USE_V8=1", "-D LVGL_USE_V8=0", text)
+    text = re.sub(r"-D LVGL_USE_V9=0", f"-D LVGL_USE_V9=1 -D LV_PORT_DRAW_UNITS={units}", text)
+    text = re.sub(r"^(\s*)(lvgl=\S+v8\.\S+)", r"\1; \2", text, flags=re.M)
+    text = re.sub(r"^(\s*); (lvgl=\S+#master)", r"\1\2", text, flags=re.M)
+    text = text.replace(".pio/libdeps/", ".pio/libdeps_v9/")
+    text = text.replace("[platformio]", f"[platformio]\nbuild_dir = .pio/build_{name}\nlibdeps_dir = .pio/libdeps_v9", 1)
+
+    path = os.path.join(PROJECT_DIR, ".pio", f"platformio_{name}.ini")
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as f:
+        f.write(text)
+    return path, os.path.join(PROJECT_DIR, ".pio", f"build_{name}")
+
+
+def run_board(board, lvgl, args, units=1):
+    env = "emulator_" + board
+    conf, build_dir = project_conf(lvgl, units)
+    subprocess.run(["pio", "run", "-d", PROJECT_DIR, "-c", conf, "-e", env], check=True)
+
+    name = lvgl if units == 1 else f"{lvgl}_units{units}"
+    out = os.path.join(args.out, f"{name}_{board}.json")
+    cmd = [os.path.join(build_dir, env, "program"), "--headless", "--bench", out,
+           "--bench-warmup", str(args.warmup), "--bench-frames", str(args.frames),
+           "--bench-samples", str(args.samples)]
+    subprocess.run(cmd, check=True, timeout=args.timeout)
+    with open(out) as f:
+        return json.load(f)
+
+
+def write_csv(path, results):
+    fields = ["lvgl", "board", "draw_units", "scene", "render_us", "flush_us", "frame_us", "frame_us_sd", "fps"]
+    with open(path, "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(fields)
+        for key, res in sorted(results.items()):
+            lvgl, board = key.split("/")
+            for s in res["scenes"]:
+                w.writerow([lvgl, board, res.get("draw_units", 1), s["name"]] + [s[k] for k in fields[4:]])
+
+
+def print_scaling(results, units):
+    """FPS of each v9 scene with more draw units relative to one"""
+    for key, res in sorted(results.items()):
+        lvgl, board = key.split("/")
+        if lvgl != "v9":
+            continue
+        base = {s["name"]: s["fps"] for s in res["scenes"]}
+        print(f"{board}: FPS relative to 1 draw unit")
+        print("  " + f"{'scene':<16}" + "".join(f"{n:>8}" for n in units))
+        for name, fps in base.items():
+            row = []
+            for n in units:
+                other = res if n == 1 else results.get(f"v9_units{n}/{board}")
+                scene = next((s for s in other["scenes"] if s["name"] == name), None) if other else None
+                row.append(f"{scene['fps'] / fps:>7.2f}x" if scene and fps > 0 else f"{'-':>8}")
+            print(f"  {name:<16}" + "".join(row))
+
+
+def compare(results, baseline, threshold, sigma):
+    """Scenes slower than the baseline by threshold percent and sigma combined standard deviations"""
+    regressions = []
+    for key, res in results.items():
+        base = baseline.get(key)
+        if base is None:
+            continue
+        base_scenes = {s["name"]: s for s in base["scenes"]}
+        for s in res["scenes"]:
+            b = base_scenes.get(s["name"])
+            if b is None or b["frame_us"] <= 0:
+                continue
+            delta = s["frame_us"] - b["frame_us"]
+            noise = math.sqrt(s["frame_us_sd"] ** 2 + b["frame_us_sd"] ** 2)
+            if delta > b["frame_us"] * threshold / 100 and delta > sigma * noise:
+                regressions.append((key, s["name"], b["frame_us"], s["frame_us"], 100 * delta / b["frame_us"]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--boards", nargs="+", default=BOARDS, choices=BOARDS)
+    parser.add_argument("--lvgl", nargs="+", default=LVGL_VERSIONS, choices=LVGL_VERSIONS)
+    parser.add_argument("--out", default="bench", help="result directory")
+    parser.add_argument("--warmup", type=int, default=5, help="frames before the first sample of a scene")
+    parser.add_argument("--frames", type=int, default=30, help="frames per sample")
+    parser.add_argument("--samples", type=int, default=5, help="samples per scene")
+    parser.add_argument("--timeout", type=int, default=600, help="seconds per board")
+    parser.add_argument("--baseline", help="results.json of an earlier run to compare against")
+    parser.add_argument("--threshold", type=float, default=10, help="allowed slowdown per scene [%%]")
+    parser.add_argument("--sigma", type=float, default=3, help="slowdown must also exceed this many std devs")
+    parser.add_argument("--update-baseline", metavar="FILE", help="store this run as the new baseline")
+    parser.add_argument("--draw-units", nargs="+", type=int, default=[1], metavar="N",
+                        help="also run v9 with N software draw units, results are keyed v9_unitsN")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    results = {}
+    units = sorted(set([1] + args.draw_units))
+    for lvgl in args.lvgl:
+        for board in args.boards:
+            results[f"{lvgl}/{board}"] = run_board(board, lvgl, args)
+            if lvgl != "v9":
+                continue
+            for n in units[1:]:
+                results[f"v9_units{n}/{board}"] = run_board(board, lvgl, args, n)
+
+    with open(os.path.join(args.out, "results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    write_csv(os.path.join(args.out, "results.csv"), results)
+    print(f"Results written to {args.out}/results.json and {args.out}/results.csv")
+    if len(units) > 1 and "v9" in args.lvgl:
+        print_scaling(results, units)
+
+    if args.update_baseline:
+        with open(args.update_baseline, "w") as f:
+            json.dump(results, f, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare(results, baseline, args.threshold, args.sigma)
+        for key, scene, base_us, cur_us, pct in regressions:
+            print(f"REGRESSION {key} {scene}: {base_us:.1f} -> {cur_us:.1f} us/frame (+{pct:.1f}%)")
+        if regressions:
+            return 1
+        print("No regressions against", args.baseline)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
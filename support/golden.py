@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+Golden image test for the emulator
+
+Builds every emulator board for LVGL v8 and/or v9, renders the port's golden scenes headless
+(--headless --golden <dir>) and compares each screenshot with the stored golden image of that board.
+A scene fails when more than --max-diff-pct percent of its pixels differ by more than --tolerance in any
+8-bit channel, and the failing pixels are written to <scene>_diff.png next to the screenshot.
+With --render-modes every board is rendered once per render mode against the same golden images, which
+shows that a flush kernel or buffer mode change left the pixels alone. A scene without a golden image is
+skipped with a notice until --update stores the screenshots as the new golden images; a golden image without
+a screenshot fails, the firmware did not write that scene.
+Golden images are stored for v8 only: v9 builds against LVGL master, which moves under them. For v9 the
+first render mode is the reference the other render modes are compared with.
+
+    python3 support/golden.py --update
+    python3 support/golden.py
+    python3 support/golden.py --boards Core2 --lvgl v9 --render-modes partial direct full
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+
+from benchmark import BOARDS, LVGL_VERSIONS, PROJECT_DIR, project_conf
+
+RENDER_MODES = ["partial", "direct", "full"]
+GOLDEN_DIR = os.path.join(PROJECT_DIR, "support", "golden")
+GOLDEN_LVGL = ["v8"]  # versions with stored golden images
+
+
+def render_board(board, lvgl, mode, args):
+    """Directory with the board's scene screenshots in the render mode"""
+    env = "emulator_" + board
+    conf, build_dir = project_conf(lvgl)
+    subprocess.run(["pio", "run", "-d", PROJECT_DIR, "-c", conf, "-e", env], check=True)
+
+    out = os.path.abspath(os.path.join(args.out, f"{lvgl}_{board}_{mode}"))
+    shutil.rmtree(out, ignore_errors=True)
+    os.makedirs(out)
+    cmd = [os.path.join(build_dir, env, "program"), "--headless", "--golden", out, "--render-mode", mode]
+    subprocess.run(cmd, check=True, timeout=args.timeout)
+    return out
+
+
+def compare(shot, golden, diff_path, tolerance):
+    """Share [%] of the pixels of `shot` that differ from `golden` by more than tolerance and their count,
+    None when the sizes differ"""
+    from PIL import Image, ImageChops
+
+    a = Image.open(shot).convert("RGB")
+    b = Image.open(golden).convert("RGB")
+    if a.size != b.size:
+        return None
+    r, g, bl = ImageChops.difference(a, b).split()
+    worst = ImageChops.lighter(ImageChops.lighter(r, g), bl)
+    bad = worst.point(lambda v: 255 if v > tolerance else 0)
+    count = bad.histogram()[255]
+    if count:
+        diff = a.convert("L").convert("RGB")  # the screenshot in gray, failing pixels in red
+        diff.paste((255, 0, 0), mask=bad)
+        diff.save(diff_path)
+    return 100 * count / (a.width * a.height), count
+
+
+def check_board(golden_dir, out, args):
+    """Failure messages of the board's screenshots against the golden images in golden_dir, and the scenes
+    skipped for lack of a golden image"""
+    shots = {f for f in os.listdir(out) if f.endswith(".png") and not f.endswith("_diff.png")}
+    goldens = set()
+    if os.path.isdir(golden_dir):
+        goldens = {f for f in os.listdir(golden_dir) if f.endswith(".png") and not f.endswith("_diff.png")}
+    failures = []
+    skipped = []
+    for name in sorted(shots | goldens):
+        shot = os.path.join(out, name)
+        golden = os.path.join(golden_dir, name)
+        scene = name[:-4]
+        if args.update:
+            if name in shots:
+                os.makedirs(golden_dir, exist_ok=True)
+                shutil.copyfile(shot, golden)
+            continue
+        if name not in shots:
+            failures.append(f"{scene}: no screenshot was written")
+            continue
+        if name not in goldens:
+            skipped.append(scene)
+            continue
+        result = compare(shot, golden, os.path.join(out, scene + "_diff.png"), args.tolerance)
+        if result is None:
+            failures.append(f"{scene}: size differs from the golden image")
+            continue
+        pct, count = result
+        if pct > args.max_diff_pct:
+            failures.append(f"{scene}: {count} pixels ({pct:.2f}%) differ, see {scene}_diff.png")
+    return failures, skipped
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--boards", nargs="+", default=BOARDS, choices=BOARDS)
+    parser.add_argument("--lvgl", nargs="+", default=GOLDEN_LVGL, choices=LVGL_VERSIONS)
+    parser.add_argument("--render-modes", nargs="+", default=["partial"], choices=RENDER_MODES)
+    parser.add_argument("--out", default="golden_out", help="screenshot directory")
+    parser.add_argument("--tolerance", type=int, default=8, help="allowed difference per 8-bit channel")
+    parser.add_argument("--max-diff-pct", type=float, default=0.0, help="allowed share of differing pixels [%%]")
+    parser.add_argument("--timeout", type=int, default=300, help="seconds per board and render mode")
+    parser.add_argument("--update", action="store_true", help="store the screenshots as the golden images")
+    args = parser.parse_args()
+
+    try:
+        import PIL  # noqa: F401
+    except ImportError:
+        print("ERROR: Pillow is required, pip install pillow")
+        return 1
+
+    failed = 0
+    skipped = 0
+    for lvgl in args.lvgl:
+        if lvgl not in GOLDEN_LVGL and (args.update or len(args.render_modes) < 2):
+            print(f"{lvgl} has no stored golden images, compare two or more --render-modes instead")
+            continue
+        for board in args.boards:
+            key = f"{lvgl}_{board}"
+            golden_dir = os.path.join(GOLDEN_DIR, key)
+            for i, mode in enumerate(args.render_modes):
+                out = render_board(board, lvgl, mode, args)
+                if lvgl not in GOLDEN_LVGL and i == 0:
+                    golden_dir = out  # the reference of the other render modes
+                    continue
+                failures, skip = check_board(golden_dir, out, args)
+                for f in failures:
+                    print(f"FAIL {key} {mode} {f}")
+                if skip:
+                    print(f"SKIP {key} {mode}: no golden image of {', '.join(skip)} in "
+                          f"{os.path.relpath(golden_dir, PROJECT_DIR)}, store them with --update")
+                failed += len(failures)
+                skipped += len(skip)
+                if args.update:
+                    print(f"Golden images of {key} updated from the {mode} render mode")
+                    break  # the other render modes are compared against them next run
+
+    if failed:
+        print(f"{failed} scene(s) failed against the golden images")
+        return 1
+    if skipped:
+        print(f"{skipped} scene(s) skipped without a golden image, the others match")
+    elif not args.update:
+        print("All scenes match the golden images")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
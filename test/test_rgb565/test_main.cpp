@@ -0,0 +1,92 @@
+// Checks the dispatched RGB565 kernel against the scalar one, run with: pio test -e test_native
+#include <unity.h>
+#include <cstring>  // for memcmp, memcpy, memset
+#include "lvgl_port_rgb565.hpp"
+
+// Odd sizes around the vector widths plus one long run
+static const size_t sizes[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1027};
+#define MAX_COUNT (1027 + 8)
+#define MAX_OFFSET 8  // every 2 byte misalignment of the vector loads and stores
+
+// 16 byte aligned, so each offset is the same misalignment on every run
+alignas(16) static uint16_t src[MAX_COUNT];
+alignas(16) static uint16_t ref[MAX_COUNT];
+alignas(16) static uint16_t out[MAX_COUNT];
+
+void setUp(void)
+{
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        src[i] = (uint16_t)(i * 0x9E37u + 0x1234u);
+    }
+}
+
+void tearDown(void)
+{
+}
+
+static void test_scalar_swaps_bytes(void)
+{
+    const uint16_t in[3] = {0x1234, 0xABCD, 0x00FF};
+    uint16_t res[3];
+    lvgl_port_rgb565_swap_scalar(res, in, 3);
+    TEST_ASSERT_EQUAL_HEX16(0x3412, res[0]);
+    TEST_ASSERT_EQUAL_HEX16(0xCDAB, res[1]);
+    TEST_ASSERT_EQUAL_HEX16(0xFF00, res[2]);
+}
+
+static void test_kernel_matches_scalar(void)
+{
+    for (size_t count : sizes) {
+        for (size_t offset = 0; offset < MAX_OFFSET; offset++) {
+            memset(ref, 0xA5, sizeof(ref));
+            memset(out, 0xA5, sizeof(out));
+            lvgl_port_rgb565_swap_scalar(ref + offset, src + offset, count);
+            lvgl_port_rgb565_swap(out + offset, src + offset, count);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(ref, out, sizeof(ref), lvgl_port_rgb565_kernel_name());
+        }
+    }
+}
+
+// Source and destination misaligned differently: the kernels load unaligned and store aligned
+static void test_kernel_src_dst_offsets(void)
+{
+    for (size_t count : sizes) {
+        for (size_t src_offset = 0; src_offset < MAX_OFFSET; src_offset++) {
+            for (size_t dst_offset = 0; dst_offset < MAX_OFFSET; dst_offset++) {
+                if (src_offset == dst_offset) {
+                    continue;  // test_kernel_matches_scalar
+                }
+                memset(ref, 0xA5, sizeof(ref));
+                memset(out, 0xA5, sizeof(out));
+                lvgl_port_rgb565_swap_scalar(ref + dst_offset, src + src_offset, count);
+                lvgl_port_rgb565_swap(out + dst_offset, src + src_offset, count);
+                TEST_ASSERT_EQUAL_MEMORY_MESSAGE(ref, out, sizeof(ref), lvgl_port_rgb565_kernel_name());
+            }
+        }
+    }
+}
+
+static void test_kernel_in_place(void)
+{
+    for (size_t count : sizes) {
+        for (size_t offset = 0; offset < MAX_OFFSET; offset++) {
+            memcpy(ref, src, sizeof(ref));
+            memcpy(out, src, sizeof(out));
+            lvgl_port_rgb565_swap_scalar(ref + offset, ref + offset, count);
+            lvgl_port_rgb565_swap(out + offset, out + offset, count);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(ref, out, sizeof(ref), lvgl_port_rgb565_kernel_name());
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_scalar_swaps_bytes);
+    RUN_TEST(test_kernel_matches_scalar);
+    RUN_TEST(test_kernel_src_dst_offsets);
+    RUN_TEST(test_kernel_in_place);
+    return UNITY_END();
+}